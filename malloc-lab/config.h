@@ -53,14 +53,21 @@
 #define UTIL_WEIGHT .60
 
 /* 
- * Alignment requirement in bytes (either 4 or 8) 
+ * Alignment requirement in bytes (8, or 16 with -DALIGNMENT=16 for the
+ * x86-64 ABI; mm.c reads the same flag)
  */
-#define ALIGNMENT 8  
+#ifndef ALIGNMENT
+#define ALIGNMENT 8
+#endif
 
 /* 
- * Maximum heap size in bytes 
+ * Maximum heap size in bytes (override with -DMAX_HEAP=..., e.g. for
+ * policies such as POLICY_BUDDY whose rounding needs more than 20 MB
+ * on the random traces)
  */
+#ifndef MAX_HEAP
 #define MAX_HEAP (20*(1<<20))  /* 20 MB */
+#endif
 
 /*****************************************************************************
  * Set exactly one of these USE_xxx constants to "1" to select a timing method
@@ -31,9 +31,10 @@ extern char *optarg; // Added declaration for optarg
 #define MAXLINE 1024	   /* max string size */
 #define HDRLINES 4		   /* number of header lines in a trace file */
 #define LINENUM(i) (i + 5) /* cnvt trace request nums to linenums (origin 1) */
+#define MAXPOLICIES 16	   /* max policies compared with -P */
 
 /* Returns true if p is ALIGNMENT-byte aligned */
-#define IS_ALIGNED(p) ((((unsigned int)(p)) % ALIGNMENT) == 0)
+#define IS_ALIGNED(p) ((((size_t)(p)) % ALIGNMENT) == 0)
 
 /******************************
  * The key compound data types
@@ -93,6 +94,10 @@ typedef struct
 
 	/* defined only for the student malloc package */
 	double util; /* space utilization for this trace (always 0 for libc) */
+	double peak; /* high water mark of heap + mapped bytes (mem_footprint) */
+	double brk;	 /* heap + mapped bytes at the end of the util run */
+	double rss;	 /* resident bytes at the end of the util run (mem_resident) */
+	double sbrks; /* heap-growing mem_sbrk calls in the util run */
 
 	/* Note: secs and util are only defined if valid is true */
 } stats_t;
@@ -134,9 +139,16 @@ static void eval_libc_speed(void *ptr);
 static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges);
 static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges);
 static void eval_mm_speed(void *ptr);
+static stats_t *eval_mm(char **tracefiles, int num_tracefiles);
+static double perf_index(int n, stats_t *stats, double *p1, double *p2);
 
 /* Various helper routines */
 static void printresults(int n, stats_t *stats);
+static void printmemory(int n, stats_t *stats);
+#ifdef MM_POLICIES
+static void printpolicies(int np, char **policies, stats_t **stats,
+						  int *policy_errors, int n);
+#endif
 static void usage(void);
 static void unix_error(char *msg);
 static void malloc_error(int tracenum, int opnum, char *msg);
@@ -152,7 +164,6 @@ int main(int argc, char **argv)
 	char **tracefiles = NULL;	/* null-terminated array of trace file names */
 	int num_tracefiles = 0;		/* the number of traces in that array */
 	trace_t *trace = NULL;		/* stores a single trace file in memory */
-	range_t *ranges = NULL;		/* keeps track of block extents for one trace */
 	stats_t *libc_stats = NULL; /* libc stats for each trace */
 	stats_t *mm_stats = NULL;	/* mm (i.e. student) stats for each trace */
 	speed_t speed_params;		/* input parameters to the xx_speed routines */
@@ -162,13 +173,19 @@ int main(int argc, char **argv)
 	int autograder = 0; /* If set, emit summary info for autograder (-g) */
 
 	/* temporaries used to compute the performance index */
-	double secs, ops, util, avg_mm_util, avg_mm_throughput, p1, p2, perfindex;
+	double p1, p2, perfindex;
 	int numcorrect;
 
+#ifdef MM_POLICIES
+	char *policies[MAXPOLICIES]; /* policies to compare (-P) */
+	int num_policies = 0;
+	char *name;
+#endif
+
 	/*
 	 * Read and interpret the command line arguments
 	 */
-	while ((c = getopt(argc, argv, "f:t:hvVgal")) != EOF)
+	while ((c = getopt(argc, argv, "f:t:hvVgalP:")) != EOF)
 	{
 		printf("getopt returned: %d\n", c); // 디버깅용 출력 추가
 
@@ -204,6 +221,31 @@ int main(int argc, char **argv)
 		case 'V': /* Be more verbose than -v */
 			verbose = 2;
 			break;
+#ifdef MM_POLICIES
+		case 'P': /* Compare these policies ("all" for every one) */
+			if (!strcmp(optarg, "all"))
+			{
+				const char *const *names = mm_policy_names();
+				for (i = 0; names[i] != NULL && num_policies < MAXPOLICIES; i++)
+					policies[num_policies++] = (char *)names[i];
+				break;
+			}
+			for (name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ","))
+			{
+				if (mm_policy_select(name) < 0)
+				{
+					printf("ERROR: Unknown policy %s\n", name);
+					exit(1);
+				}
+				if (num_policies == MAXPOLICIES)
+				{
+					printf("ERROR: At most %d policies with -P\n", MAXPOLICIES);
+					exit(1);
+				}
+				policies[num_policies++] = name;
+			}
+			break;
+#endif
 		case 'h': /* Print this message */
 			usage();
 			exit(0);
@@ -297,86 +339,67 @@ int main(int argc, char **argv)
 		}
 	}
 
-	/*
-	 * Always run and evaluate the student's mm package
-	 */
-	if (verbose > 1)
-		printf("\nTesting mm malloc\n");
-
-	/* Allocate the mm stats array, with one stats_t struct per tracefile */
-	mm_stats = (stats_t *)calloc(num_tracefiles, sizeof(stats_t));
-	if (mm_stats == NULL)
-		unix_error("mm_stats calloc in main failed");
-
 	/* Initialize the simulated memory system in memlib.c */
 	mem_init();
 
-	/* Evaluate student's mm malloc package using the K-best scheme */
-	for (i = 0; i < num_tracefiles; i++)
+#ifdef MM_POLICIES
+	/*
+	 * Run every selected policy on the same traces and compare them
+	 */
+	if (num_policies > 0)
 	{
-		trace = read_trace(tracedir, tracefiles[i]);
-		mm_stats[i].ops = trace->num_ops;
-		if (verbose > 1)
-			printf("Checking mm_malloc for correctness, ");
-		mm_stats[i].valid = eval_mm_valid(trace, i, &ranges);
-		if (mm_stats[i].valid)
+		stats_t *policy_stats[MAXPOLICIES];
+		int policy_errors[MAXPOLICIES];
+
+		for (i = 0; i < num_policies; i++)
 		{
+			mm_policy_select(policies[i]);
+			errors = 0;
 			if (verbose > 1)
-				printf("efficiency, ");
-			mm_stats[i].util = eval_mm_util(trace, i, &ranges);
-			speed_params.trace = trace;
-			speed_params.ranges = ranges;
-			if (verbose > 1)
-				printf("and performance.\n");
-			mm_stats[i].secs = fsecs(eval_mm_speed, &speed_params);
+				printf("\nTesting mm malloc (%s)\n", policies[i]);
+			policy_stats[i] = eval_mm(tracefiles, num_tracefiles);
+			policy_errors[i] = errors;
+			if (verbose)
+			{
+				printf("\nResults for mm malloc (%s):\n", policies[i]);
+				printresults(num_tracefiles, policy_stats[i]);
+			}
 		}
-		free_trace(trace);
+		printf("\nPolicy comparison (util and Kops per trace):\n");
+		printpolicies(num_policies, policies, policy_stats, policy_errors,
+					  num_tracefiles);
+		exit(0);
 	}
+#endif
+
+	/*
+	 * Always run and evaluate the student's mm package
+	 */
+	if (verbose > 1)
+		printf("\nTesting mm malloc\n");
+	mm_stats = eval_mm(tracefiles, num_tracefiles);
 
 	/* Display the mm results in a compact table */
 	if (verbose)
 	{
 		printf("\nResults for mm malloc:\n");
 		printresults(num_tracefiles, mm_stats);
+		printf("\nMemory for mm malloc (KB, end = after the last request):\n");
+		printmemory(num_tracefiles, mm_stats);
 		printf("\n");
 	}
 
-	/*
-	 * Accumulate the aggregate statistics for the student's mm package
-	 */
-	secs = 0;
-	ops = 0;
-	util = 0;
 	numcorrect = 0;
 	for (i = 0; i < num_tracefiles; i++)
-	{
-		secs += mm_stats[i].secs;
-		ops += mm_stats[i].ops;
-		util += mm_stats[i].util;
 		if (mm_stats[i].valid)
 			numcorrect++;
-	}
-	avg_mm_util = util / num_tracefiles;
 
 	/*
 	 * Compute and print the performance index
 	 */
 	if (errors == 0)
 	{
-		avg_mm_throughput = ops / secs;
-
-		p1 = UTIL_WEIGHT * avg_mm_util;
-		if (avg_mm_throughput > AVG_LIBC_THRUPUT)
-		{
-			p2 = (double)(1.0 - UTIL_WEIGHT);
-		}
-		else
-		{
-			p2 = ((double)(1.0 - UTIL_WEIGHT)) *
-				 (avg_mm_throughput / AVG_LIBC_THRUPUT);
-		}
-
-		perfindex = (p1 + p2) * 100.0;
+		perfindex = perf_index(num_tracefiles, mm_stats, &p1, &p2);
 		printf("Perf index = %.0f (util) + %.0f (thru) = %.0f/100\n",
 			   p1 * 100,
 			   p2 * 100,
@@ -427,9 +450,11 @@ static int add_range(range_t **ranges, char *lo, int size,
 		return 0;
 	}
 
-	/* The payload must lie within the extent of the heap */
-	if ((lo < (char *)mem_heap_lo()) || (lo > (char *)mem_heap_hi()) ||
-		(hi < (char *)mem_heap_lo()) || (hi > (char *)mem_heap_hi()))
+	/* The payload must lie within the extent of the heap
+	 * (or inside one of the mappings handed out by mem_map) */
+	if (((lo < (char *)mem_heap_lo()) || (lo > (char *)mem_heap_hi()) ||
+		 (hi < (char *)mem_heap_lo()) || (hi > (char *)mem_heap_hi())) &&
+		!mem_is_mapped(lo, hi))
 	{
 		sprintf(msg, "Payload (%p:%p) lies outside heap (%p:%p)",
 				lo, hi, mem_heap_lo(), mem_heap_hi());
@@ -736,9 +761,10 @@ static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges)
  *   an optimal allocator, i.e., no gaps and no internal fragmentation.
  *   Utilization is the ratio hwm/heapsize, where heapsize is the
  *   size of the heap in bytes after running the student's malloc
- *   package on the trace. Note that our implementation of mem_sbrk()
- *   doesn't allow the students to decrement the brk pointer, so brk
- *   is always the high water mark of the heap.
+ *   package on the trace. The brk can move back down (mem_shrink), and
+ *   blocks placed in mem_map() mappings count too, so the denominator
+ *   is mem_footprint(), the high water mark of heap size plus mapped
+ *   bytes.
  *
  */
 static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges)
@@ -753,6 +779,7 @@ static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges)
 
 	/* initialize the heap and the mm malloc package */
 	mem_reset_brk();
+	mem_decommit(mem_heap_lo(), MAX_HEAP); /* start the RSS count from zero */
 	if (mm_init() < 0)
 		app_error("mm_init failed in eval_mm_util");
 
@@ -819,7 +846,8 @@ static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges)
 		}
 	}
 
-	return ((double)max_total_size / (double)mem_heapsize());
+	/* peak heap + mapped bytes (== mem_heapsize() when nothing is mapped) */
+	return ((double)max_total_size / (double)mem_footprint());
 }
 
 /*
@@ -870,6 +898,87 @@ static void eval_mm_speed(void *ptr)
 		}
 }
 
+/*
+ * eval_mm - Evaluate the mm malloc package on every tracefile and
+ *     return one stats_t struct per tracefile
+ */
+static stats_t *eval_mm(char **tracefiles, int num_tracefiles)
+{
+	int i;
+	trace_t *trace;
+	range_t *ranges = NULL;
+	speed_t speed_params;
+	stats_t *mm_stats;
+
+	/* Allocate the mm stats array, with one stats_t struct per tracefile */
+	mm_stats = (stats_t *)calloc(num_tracefiles, sizeof(stats_t));
+	if (mm_stats == NULL)
+		unix_error("mm_stats calloc in eval_mm failed");
+
+	/* Evaluate student's mm malloc package using the K-best scheme */
+	for (i = 0; i < num_tracefiles; i++)
+	{
+		trace = read_trace(tracedir, tracefiles[i]);
+		mm_stats[i].ops = trace->num_ops;
+		if (verbose > 1)
+			printf("Checking mm_malloc for correctness, ");
+		mm_stats[i].valid = eval_mm_valid(trace, i, &ranges);
+		if (mm_stats[i].valid)
+		{
+			if (verbose > 1)
+				printf("efficiency, ");
+			mm_stats[i].util = eval_mm_util(trace, i, &ranges);
+			mm_stats[i].peak = mem_footprint();
+			mm_stats[i].brk = mem_heapsize() + mem_mapped_size();
+			mm_stats[i].rss = mem_resident();
+			mm_stats[i].sbrks = mem_sbrk_calls();
+			speed_params.trace = trace;
+			speed_params.ranges = ranges;
+			if (verbose > 1)
+				printf("and performance.\n");
+			mm_stats[i].secs = fsecs(eval_mm_speed, &speed_params);
+		}
+		free_trace(trace);
+	}
+	clear_ranges(&ranges);
+	return mm_stats;
+}
+
+/*
+ * perf_index - Compute the performance index of the mm package from
+ *     its per-trace stats: p1 is the utilization part and p2 the
+ *     throughput part (both in 0..1)
+ */
+static double perf_index(int n, stats_t *stats, double *p1, double *p2)
+{
+	int i;
+	double secs = 0, ops = 0, util = 0;
+	double avg_mm_util, avg_mm_throughput;
+
+	/* Accumulate the aggregate statistics for the student's mm package */
+	for (i = 0; i < n; i++)
+	{
+		secs += stats[i].secs;
+		ops += stats[i].ops;
+		util += stats[i].util;
+	}
+	avg_mm_util = util / n;
+	avg_mm_throughput = ops / secs;
+
+	*p1 = UTIL_WEIGHT * avg_mm_util;
+	if (avg_mm_throughput > AVG_LIBC_THRUPUT)
+	{
+		*p2 = (double)(1.0 - UTIL_WEIGHT);
+	}
+	else
+	{
+		*p2 = ((double)(1.0 - UTIL_WEIGHT)) *
+			  (avg_mm_throughput / AVG_LIBC_THRUPUT);
+	}
+
+	return (*p1 + *p2) * 100.0;
+}
+
 /*
  * eval_libc_valid - We run this function to make sure that the
  *    libc malloc can run to completion on the set of traces.
@@ -965,6 +1074,90 @@ static void eval_libc_speed(void *ptr)
  * Some miscellaneous helper routines
  ************************************/
 
+/*
+ * printmemory - prints the memory footprint of the student's package:
+ *   the peak, what is still held at the end of the trace, and how much
+ *   of the simulated heap and mappings is actually resident
+ */
+static void printmemory(int n, stats_t *stats)
+{
+	int i;
+
+	printf("%5s%10s%10s%10s%8s\n", "trace", "peak", "end", "rss", "sbrk");
+	for (i = 0; i < n; i++)
+	{
+		if (stats[i].valid)
+			printf("%2d%13.0f%10.0f%10.0f%8.0f\n",
+				   i,
+				   stats[i].peak / 1024,
+				   stats[i].brk / 1024,
+				   stats[i].rss / 1024,
+				   stats[i].sbrks);
+		else
+			printf("%2d%13s%10s%10s%8s\n", i, "-", "-", "-", "-");
+	}
+}
+
+#ifdef MM_POLICIES
+/*
+ * printpolicies - prints the per-trace utilization and throughput of
+ *   several policies side by side, followed by their totals and
+ *   performance indexes
+ */
+static void printpolicies(int np, char **policies, stats_t **stats,
+						  int *policy_errors, int n)
+{
+	int i, j;
+	double p1, p2;
+
+	printf("%5s", "trace");
+	for (j = 0; j < np; j++)
+		printf("%16s", policies[j]);
+	printf("\n");
+	for (i = 0; i < n; i++)
+	{
+		printf("%2d   ", i);
+		for (j = 0; j < np; j++)
+		{
+			if (stats[j][i].valid)
+				printf("%7.0f%%%8.0f",
+					   stats[j][i].util * 100.0,
+					   (stats[j][i].ops / 1e3) / stats[j][i].secs);
+			else
+				printf("%8s%8s", "-", "-");
+		}
+		printf("\n");
+	}
+
+	/* Totals and performance index of each policy */
+	printf("%5s", "Total");
+	for (j = 0; j < np; j++)
+	{
+		double secs = 0, ops = 0, util = 0;
+
+		for (i = 0; i < n; i++)
+		{
+			secs += stats[j][i].secs;
+			ops += stats[j][i].ops;
+			util += stats[j][i].util;
+		}
+		if (policy_errors[j] == 0)
+			printf("%7.0f%%%8.0f", (util / n) * 100.0, (ops / 1e3) / secs);
+		else
+			printf("%8s%8s", "-", "-");
+	}
+	printf("\n%5s", "Perf");
+	for (j = 0; j < np; j++)
+	{
+		if (policy_errors[j] == 0)
+			printf("%16.0f", perf_index(n, stats[j], &p1, &p2));
+		else
+			printf("%9d errors", policy_errors[j]);
+	}
+	printf("\n");
+}
+#endif
+
 /*
  * printresults - prints a performance summary for some malloc package
  */
@@ -1058,13 +1251,20 @@ void malloc_error(int tracenum, int opnum, char *msg)
  */
 static void usage(void)
 {
+#ifdef MM_POLICIES
+	fprintf(stderr, "Usage: mdriver-all [-hvVal] [-f <file>] [-t <dir>] [-P <policies>]\n");
+#else
 	fprintf(stderr, "Usage: mdriver [-hvVal] [-f <file>] [-t <dir>]\n");
+#endif
 	fprintf(stderr, "Options\n");
 	fprintf(stderr, "\t-a         Don't check the team structure.\n");
 	fprintf(stderr, "\t-f <file>  Use <file> as the trace file.\n");
 	fprintf(stderr, "\t-g         Generate summary info for autograder.\n");
 	fprintf(stderr, "\t-h         Print this message.\n");
 	fprintf(stderr, "\t-l         Run libc malloc as well.\n");
+#ifdef MM_POLICIES
+	fprintf(stderr, "\t-P <list>  Compare these policies, e.g. explicit_ff,tlsf (or \"all\").\n");
+#endif
 	fprintf(stderr, "\t-t <dir>   Directory to find default traces.\n");
 	fprintf(stderr, "\t-v         Print per-trace performance breakdowns.\n");
 	fprintf(stderr, "\t-V         Print additional debug info.\n");
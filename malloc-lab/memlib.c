@@ -2,7 +2,23 @@
  * memlib.c - a module that simulates the memory system.  Needed because it 
  *            allows us to interleave calls from the student's malloc package 
  *            with the system's malloc package in libc.
+ *
+ *            Besides the simulated brk heap, the model hands out real
+ *            anonymous mappings (mem_map/mem_unmap/mem_remap) for large
+ *            blocks. They lie outside mem_heap_lo..mem_heap_hi, so the
+ *            driver asks mem_is_mapped() and measures space with
+ *            mem_footprint() (peak of heap size + mapped bytes).
+ *
+ *            The brk can be lowered again with mem_shrink, and pages of
+ *            the heap can be handed back with mem_decommit; the driver
+ *            reports how much is still resident with mem_resident().
+ *
+ *            The heap storage starts out zero-filled. mem_heap_fresh()
+ *            returns the first byte that mem_sbrk has never handed out,
+ *            so everything from there up still reads as zero (an
+ *            allocator's calloc need not clear it).
  */
+#define _GNU_SOURCE /* mremap */
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -19,19 +35,56 @@ static char *mem_start_brk; // 힙의 시작             /* points to first byte
 static char *mem_brk;       // 현재 brk(힙의 끝)     /* points to last byte of heap */
 static char *mem_max_addr;  // 힙 최댓값             /* largest legal heap address */ 
 
+/* mapped regions - brk 힙 밖의 익명 매핑 */
+#define MEM_MAX_MAPS 1024
+static struct {
+    char *start;            /* first byte of the mapping */
+    size_t size;            /* length in bytes (multiple of the page size) */
+} mem_maps[MEM_MAX_MAPS];
+static int mem_nmaps;       // 현재 매핑 개수
+static size_t mem_mapped;   // 현재 매핑된 바이트 수  /* bytes currently mapped */
+static size_t mem_peak;     // 힙 + 매핑의 최댓값     /* high-water mark of heap size + mapped bytes */
+static size_t mem_nsbrk;    // 힙을 늘린 mem_sbrk 호출 수 /* growing sbrk calls since the last reset */
+static char *mem_fresh;     // 한 번도 내준 적 없는 힙의 시작 /* bytes from here up are still zero */
+
+/*
+ * mem_update_peak - record the current footprint if it is a new high
+ */
+static void mem_update_peak(void)
+{
+    size_t footprint = (size_t)(mem_brk - mem_start_brk) + mem_mapped;
+    if (footprint > mem_peak)
+        mem_peak = footprint;
+}
+
+/*
+ * mem_unmap_all - release every mapping handed out by mem_map
+ */
+static void mem_unmap_all(void)
+{
+    while (mem_nmaps > 0) {
+        mem_nmaps--;
+        munmap(mem_maps[mem_nmaps].start, mem_maps[mem_nmaps].size);
+    }
+    mem_mapped = 0;
+}
+
 /* 
  * mem_init - initialize the memory system model
  */
 void mem_init(void)
 {
-    /* allocate the storage we will use to model the available VM */
-    if ((mem_start_brk = (char *)malloc(MAX_HEAP)) == NULL) {
+    /* allocate the storage we will use to model the available VM
+       (calloc: zero-filled, and a block this large is fresh pages, so
+       nothing is actually written) */
+    if ((mem_start_brk = (char *)calloc(1, MAX_HEAP)) == NULL) {
 	fprintf(stderr, "mem_init_vm: malloc error\n");
 	exit(1);
     }
 
     mem_max_addr = mem_start_brk + MAX_HEAP;  /* max legal heap address */
     mem_brk = mem_start_brk;                  /* heap is empty initially */
+    mem_fresh = mem_start_brk;                /* and all of it is still zero */
 }
 
 /* 
@@ -39,16 +92,23 @@ void mem_init(void)
  */
 void mem_deinit(void)
 {
+    mem_unmap_all();
     free(mem_start_brk);
 }
 
 /*
  * mem_reset_brk - reset the s
  imulated brk pointer to make an empty heap
+ *     (mappings left over from the previous run are released too; the
+ *     storage the previous run used is not cleared, so mem_heap_fresh
+ *     stays where it was)
  */
 void mem_reset_brk()
 {
     mem_brk = mem_start_brk;
+    mem_unmap_all();
+    mem_peak = 0;
+    mem_nsbrk = 0;
 }
 
 /* 
@@ -66,9 +126,193 @@ void *mem_sbrk(int incr) //
 	return (void *)-1;
     }
     mem_brk += incr;
+    if (incr > 0)
+        mem_nsbrk++;
+    if (mem_brk > mem_fresh)
+        mem_fresh = mem_brk;
+    mem_update_peak();
     return (void *)old_brk;
 }
 
+/*
+ * mem_shrink - lower the brk by decr bytes and release the whole pages
+ *    that no longer belong to the heap. Returns 0, or -1 if decr is
+ *    larger than the heap. Released pages read as zero again, so
+ *    mem_heap_fresh moves down to the first page boundary above the brk.
+ */
+int mem_shrink(size_t decr)
+{
+    size_t pagesize = mem_pagesize();
+    char *hi;
+
+    if (decr > (size_t)(mem_brk - mem_start_brk)) {
+	errno = EINVAL;
+	return -1;
+    }
+    mem_brk -= decr;
+    /* everything up to mem_fresh may be dirty, not just up to the old brk */
+    hi = (char *)(((size_t)mem_fresh + pagesize - 1) & ~(pagesize - 1));
+    if (hi > mem_max_addr)
+	hi = mem_max_addr;
+    mem_decommit(mem_brk, hi - mem_brk);
+    if ((char *)((size_t)hi & ~(pagesize - 1)) >= mem_fresh)
+	mem_fresh = (char *)(((size_t)mem_brk + pagesize - 1) & ~(pagesize - 1));
+    return 0;
+}
+
+/*
+ * mem_decommit - give the pages lying entirely inside [addr, addr+len)
+ *    back to the OS (madvise(MADV_DONTNEED)). The range stays valid; the
+ *    pages read as zero when touched again.
+ */
+void mem_decommit(void *addr, size_t len)
+{
+    size_t pagesize = mem_pagesize();
+    char *lo = (char *)(((size_t)addr + pagesize - 1) & ~(pagesize - 1));
+    char *hi = (char *)(((size_t)addr + len) & ~(pagesize - 1));
+
+    if (lo < hi)
+	madvise(lo, hi - lo, MADV_DONTNEED);
+}
+
+/*
+ * mem_incore - residency of the pages of [addr, addr+len) (mincore):
+ *    bit 0 of vec[i] is set if page i is in RAM. addr is rounded down
+ *    to a page boundary. Returns 0, or -1 on error.
+ */
+int mem_incore(void *addr, size_t len, unsigned char *vec)
+{
+    size_t pagesize = mem_pagesize();
+    char *lo = (char *)((size_t)addr & ~(pagesize - 1));
+
+    return mincore(lo, (char *)addr + len - lo, vec);
+}
+
+/*
+ * mem_resident_range - bytes of [lo, hi) that are resident (mincore)
+ */
+static size_t mem_resident_range(char *lo, char *hi)
+{
+    size_t pagesize = mem_pagesize();
+    size_t npages, i, bytes = 0;
+    unsigned char *vec;
+
+    lo = (char *)((size_t)lo & ~(pagesize - 1));
+    npages = (size_t)(hi - lo + pagesize - 1) / pagesize;
+    if (hi <= lo || (vec = malloc(npages)) == NULL)
+	return 0;
+    if (mincore(lo, npages * pagesize, vec) == 0)
+	for (i = 0; i < npages; i++)
+	    bytes += (vec[i] & 1) ? pagesize : 0;
+    free(vec);
+    return bytes;
+}
+
+/*
+ * mem_resident - bytes of the simulated heap storage (the whole
+ *    MAX_HEAP area, not just up to the brk) and of the mappings that
+ *    are currently resident in RAM
+ */
+size_t mem_resident(void)
+{
+    size_t bytes = mem_resident_range(mem_start_brk, mem_max_addr);
+    int i;
+
+    for (i = 0; i < mem_nmaps; i++)
+	bytes += mem_resident_range(mem_maps[i].start, mem_maps[i].start + mem_maps[i].size);
+    return bytes;
+}
+
+/*
+ * mem_map - map size bytes (rounded up to pages) of fresh zeroed memory
+ *    outside the brk heap. Returns (void *)-1 on failure.
+ */
+void *mem_map(size_t size)
+{
+    size_t pagesize = mem_pagesize();
+    char *p;
+
+    size = (size + pagesize - 1) & ~(pagesize - 1);
+    if (mem_nmaps == MEM_MAX_MAPS) {
+	errno = ENOMEM;
+	return (void *)-1;
+    }
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+	return (void *)-1;
+
+    mem_maps[mem_nmaps].start = p;
+    mem_maps[mem_nmaps].size = size;
+    mem_nmaps++;
+    mem_mapped += size;
+    mem_update_peak();
+    return (void *)p;
+}
+
+/*
+ * mem_find_map - index of the mapping that starts at addr, or -1
+ */
+static int mem_find_map(void *addr)
+{
+    int i;
+
+    for (i = 0; i < mem_nmaps; i++)
+	if (mem_maps[i].start == (char *)addr)
+	    return i;
+    return -1;
+}
+
+/*
+ * mem_unmap - release a mapping returned by mem_map/mem_remap
+ */
+void mem_unmap(void *addr, size_t size)
+{
+    int i = mem_find_map(addr);
+
+    assert(i >= 0 && mem_maps[i].size >= size);
+    munmap(mem_maps[i].start, mem_maps[i].size);
+    mem_mapped -= mem_maps[i].size;
+    mem_maps[i] = mem_maps[--mem_nmaps];
+}
+
+/*
+ * mem_remap - grow or shrink a mapping to new_size bytes (rounded up to
+ *    pages) without copying; the mapping may move. Returns the new
+ *    address, or (void *)-1 on failure (the old mapping stays valid).
+ */
+void *mem_remap(void *addr, size_t old_size, size_t new_size)
+{
+    size_t pagesize = mem_pagesize();
+    int i = mem_find_map(addr);
+    char *p;
+
+    assert(i >= 0 && mem_maps[i].size >= old_size);
+    new_size = (new_size + pagesize - 1) & ~(pagesize - 1);
+    p = mremap(mem_maps[i].start, mem_maps[i].size, new_size, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+	return (void *)-1;
+
+    mem_mapped = mem_mapped - mem_maps[i].size + new_size;
+    mem_maps[i].start = p;
+    mem_maps[i].size = new_size;
+    mem_update_peak();
+    return (void *)p;
+}
+
+/*
+ * mem_is_mapped - true if [lo, hi] lies inside a single mapping
+ */
+int mem_is_mapped(void *lo, void *hi)
+{
+    int i;
+
+    for (i = 0; i < mem_nmaps; i++)
+	if ((char *)lo >= mem_maps[i].start &&
+	    (char *)hi < mem_maps[i].start + mem_maps[i].size)
+	    return 1;
+    return 0;
+}
+
 /*
  * mem_heap_lo - return address of the first heap byte
  */
@@ -85,6 +329,24 @@ void *mem_heap_hi()
     return (void *)(mem_brk - 1);
 }
 
+/*
+ * mem_heap_fresh - return the first heap byte that mem_sbrk has never
+ *    handed out; the storage from there up reads as zero
+ */
+void *mem_heap_fresh()
+{
+    return (void *)mem_fresh;
+}
+
+/*
+ * mem_heap_room() - returns how many more bytes mem_sbrk can hand out
+ *    before the heap reaches MAX_HEAP
+ */
+size_t mem_heap_room()
+{
+    return (size_t)(mem_max_addr - mem_brk);
+}
+
 /*
  * mem_heapsize() - returns the heap size in bytes
  */
@@ -93,6 +355,33 @@ size_t mem_heapsize()
     return (size_t)(mem_brk - mem_start_brk);
 }
 
+/*
+ * mem_footprint() - returns the peak of heap size + mapped bytes since
+ *    the last mem_reset_brk (equals mem_heapsize() if nothing was mapped)
+ */
+size_t mem_footprint()
+{
+    mem_update_peak();
+    return mem_peak;
+}
+
+/*
+ * mem_sbrk_calls() - returns how many mem_sbrk calls grew the heap
+ *    since the last mem_reset_brk
+ */
+size_t mem_sbrk_calls()
+{
+    return mem_nsbrk;
+}
+
+/*
+ * mem_mapped_size() - returns the bytes currently held in mappings
+ */
+size_t mem_mapped_size()
+{
+    return mem_mapped;
+}
+
 /*
  * mem_pagesize() - returns the page size of the system
  */
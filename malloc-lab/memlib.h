@@ -3,9 +3,24 @@
 void mem_init(void);               
 void mem_deinit(void);
 void *mem_sbrk(int incr);
+int mem_shrink(size_t decr);
+void mem_decommit(void *addr, size_t len);
+size_t mem_resident(void);
+int mem_incore(void *addr, size_t len, unsigned char *vec);
 void mem_reset_brk(void); 
 void *mem_heap_lo(void);
 void *mem_heap_hi(void);
+void *mem_heap_fresh(void);
+size_t mem_heap_room(void);
 size_t mem_heapsize(void);
+size_t mem_sbrk_calls(void);
 size_t mem_pagesize(void);
 
+/* anonymous mappings outside the brk heap (large blocks) */
+void *mem_map(size_t size);
+void mem_unmap(void *addr, size_t size);
+void *mem_remap(void *addr, size_t old_size, size_t new_size);
+int mem_is_mapped(void *lo, void *hi);
+size_t mem_footprint(void);
+size_t mem_mapped_size(void);
+
@@ -1,5 +1,5 @@
 /*
- * mm.c — Three-in-one malloc package (implicit FF, implicit NF, explicit FF)
+ * mm.c — Multi-policy malloc package (implicit FF/NF, explicit FF, segregated BF, TLSF, buddy, address-ordered FF)
  *
  * Overview
  * --------
@@ -8,17 +8,32 @@
  *   1) POLICY_IMPLICIT_FF  — implicit free list + first-fit
  *   2) POLICY_IMPLICIT_NF  — implicit free list + next-fit
  *   3) POLICY_EXPLICIT_FF  — explicit free list (doubly linked) + first-fit
+ *   4) POLICY_SEGREGATED_BF — segregated free lists + best-fit (bitmap class lookup)
+ *   5) POLICY_TLSF         — two-level segregated fit, O(1) find/insert/remove
+ *   6) POLICY_TREE_BF      — segregated lists for small blocks + size-ordered
+ *                            balanced (AA) tree for large blocks, exact best-fit
+ *   7) POLICY_BUDDY        — binary buddy system, power-of-two blocks,
+ *                            buddy found by address XOR (no footer reads)
+ *   8) POLICY_ADDRESS_FF   — explicit free blocks kept in address order in an
+ *                            AA tree augmented with the largest size per
+ *                            subtree: address-ordered first-fit, O(log n)
  *
  * Shared code (always used):
  *   - Heap initialization and extension (mm_init, extend_heap)
- *   - Block format, header/footer helpers, alignment, coalescing logic core
- *   - Allocation placement/splitting (place)
- *   - Public API: mm_malloc / mm_free / mm_realloc
+ *   - Block format, header/footer helpers, alignment
+ *   - Coalescing (coalesce), placement/splitting (place), heap trimming
+ *     and in-place realloc, written once against the policy hooks
+ *   - Public API: mm_malloc / mm_free / mm_realloc / mm_calloc, the batch
+ *     calls mm_malloc_batch / mm_free_batch, mm_usable_size / mm_try_expand,
+ *     and the aligned variants mm_memalign / mm_aligned_alloc /
+ *     mm_posix_memalign
  *
- * Policy-specific code (compiled conditionally):
- *   - find_fit(): scanning strategy (implicit FF or NF, or explicit list walk)
- *   - Free-list hooks (insert/remove) used only by explicit policy
- *   - Rover pointer used only by implicit next-fit
+ * Policy-specific code (compiled conditionally, one section per policy):
+ *   - Free-index hooks FREE_INSERT / FREE_REMOVE (list, segregated lists,
+ *     trees, TLSF or buddy lists; no-ops for the implicit policies)
+ *   - Search-state hooks FIT_PLACED / FIT_MOVED (next-fit rover)
+ *   - find_fit(): scanning strategy
+ *   - Buddy only: its own coalesce and split (power-of-two blocks)
  *
  * Switching policy (default: explicit first-fit):
  *   #define ALLOC_POLICY POLICY_EXPLICIT_FF
@@ -37,15 +52,63 @@
  * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_EXPLICIT_FF'
  * 분리 가용 리스트 + best-fit 정책
  * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_SEGREGATED_BF'
+ * 분리 가용 리스트 + best-fit 정책, 128개 크기 클래스 (구간 16개 x 하위 8개)
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_SEGREGATED_BF -DSEG_BANDS=16 -DSEG_SUB_LOG2=3'
+ * 2단계 분리 가용 리스트(TLSF) + good-fit 정책 (malloc/free 모두 O(1))
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_TLSF'
+ * 분리 가용 리스트 + 큰 블록용 크기순 균형 트리 + best-fit 정책
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_TREE_BF'
+ * 명시적 가용 블록을 주소순 균형 트리에 + 주소순 first-fit 정책 (삽입/삭제/탐색 모두 O(log n))
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_ADDRESS_FF'
+ * 이진 버디 시스템 (2의 거듭제곱 블록, 주소 XOR로 버디 병합)
+ * (2의 거듭제곱 올림 때문에 random 트레이스는 20MB 힙을 넘으므로 MAX_HEAP을 늘린다)
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_BUDDY -DMAX_HEAP=67108864'
+ * 멀티스레드 빌드 (스레드별 아레나, 가용 리스트 정책만 지원, 아레나 수는 -DMM_ARENAS=N)
+ * make clean && make CFLAGS+=' -DALLOC_POLICY=POLICY_SEGREGATED_BF -DMM_THREADS -pthread'
+ * 작은 요청(SLAB_MAX_OBJ 이하)용 슬랩 끄기 (기본은 켜짐)
+ * make clean && make CFLAGS+=' -DMM_SLAB=0'
+ * 큰 요청(MMAP_THRESHOLD 이상)용 mmap 경로 끄기 / 임계값 바꾸기 (기본은 켜짐, 128KB)
+ * make clean && make CFLAGS+=' -DMM_MMAP=0'
+ * make clean && make CFLAGS+=' -DMMAP_THRESHOLD=65536'
+ * 힙 끝 반납(trim) / 큰 가용 블록 페이지 반납 끄기 (기본은 켜짐, 128KB)
+ * make clean && make CFLAGS+=' -DMM_TRIM=0'
+ * 작은 블록(QUICK_MAX_SIZE 이하)의 해제를 quick list에 미뤄 두지 않고 바로 병합 (단일 스레드 기본은 켜짐)
+ * make clean && make CFLAGS+=' -DMM_QUICK=0'
+ * 힙 확장 단위를 할당 속도/힙 크기에 맞춰 조절하지 않음 (기본은 켜짐, 끄면 항상 MAX(asize, CHUNKSIZE))
+ * make clean && make CFLAGS+=' -DMM_ADAPT_EXTEND=0'
+ * 가용 리스트 링크를 힙 시작 기준 32비트 오프셋으로 저장 (최소 블록 24B -> 16B, 힙은 4GB 이하, 기본은 포인터)
+ * make clean && make CFLAGS+=' -DMM_OFFSET_LINKS=1'
+ * payload를 16바이트 경계에 정렬 (x86-64 ABI/SSE, 기본은 8바이트 - mdriver도 같은 값으로 검사)
+ * make clean && make CFLAGS+=' -DALIGNMENT=16'
+ * 해제된 페이지를 백그라운드 워커가 시간에 따라 반납 (MM_THREADS 전용, 감쇠 시간은 -DDECAY_MS=N 또는 MM_DECAY_MS=N)
+ * make mtbench CFLAGS+=' -DALLOC_POLICY=POLICY_SEGREGATED_BF -DMM_DECAY=1'
+ * 생산자/소비자 벤치마크 (다른 스레드가 해제하는 경로, ./mtbench -h 참고)
+ * make mtbench CFLAGS+=' -DALLOC_POLICY=POLICY_SEGREGATED_BF'
+ * 모든 정책을 한 바이너리에 (mm.c를 정책마다 -DMM_PREFIX=<이름>으로 컴파일, 실행 시 선택)
+ * make mdriver-all && ./mdriver-all -v -P explicit_ff,segregated_bf    (또는 MM_POLICY=tlsf ./mdriver-all)
  * 
  * 실행 : ./mdriver -V
  * ----
  * 
- * - Block layout: | header | payload ... | footer |
- *   header/footer store (size | alloc-bit). Size is multiple of 8.
+ * - Block layout: allocated | header | payload ...          |
+ *                 free      | header | payload ... | footer |
+ *   header stores (size | prev-alloc-bit | alloc-bit), footer stores size only.
+ *   Allocated blocks carry no footer: the next block's prev-alloc bit tells
+ *   coalesce() whether it may read the footer in front of it. Size is multiple of
+ *   ALIGNMENT (8, or 16 with -DALIGNMENT=16).
+ * - Requests up to SLAB_MAX_OBJ bytes are served from page-sized slabs
+ *   (fixed-size slots, no per-object header) unless built with -DMM_SLAB=0.
+ * - Requests of MMAP_THRESHOLD bytes or more get their own memlib mapping
+ *   (header bit 2 = MMAPPED) and are resized with mremap, unless -DMM_MMAP=0.
+ * - A free block of TRIM_THRESHOLD bytes or more at the top of the heap
+ *   lowers the brk (mem_shrink); large free blocks inside the heap have
+ *   their interior pages decommitted (mem_decommit), unless -DMM_TRIM=0.
+ *   With -DMM_DECAY=1 (MM_THREADS) a background worker purges free pages
+ *   along a time-decay curve instead.
  * - MIN_BLOCK is policy-aware:
- *     implicit  : 2*DSIZE (header+footer + min payload = 16B)
- *     explicit  : header+footer + 2 pointers in payload (≈ 24B on 64-bit)
+ *     implicit  : 2*DSIZE (header+footer of the free block + min payload = 16B)
+ *     explicit  : header+footer + 2 pointers in payload (≈ 24B on 64-bit;
+ *                 16B with -DMM_OFFSET_LINKS=1, 32-bit heap offsets as links)
  */
 
 #include <assert.h>
@@ -54,11 +117,39 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+
+/*
+ * 정책별 빌드 (mdriver-all): -DMM_PREFIX=<이름>이면 공개 함수를 <이름>_mm_init 등으로 바꿔
+ * 여러 정책의 mm.c를 한 바이너리에 링크한다. mmpolicy.c가 이들을 디스패치 표로 묶는다.
+ */
+#ifdef MM_PREFIX
+#  define MM_CAT_(a, b)        a##_##b
+#  define MM_CAT(a, b)         MM_CAT_(a, b)
+#  define mm_init              MM_CAT(MM_PREFIX, mm_init)
+#  define mm_malloc            MM_CAT(MM_PREFIX, mm_malloc)
+#  define mm_free              MM_CAT(MM_PREFIX, mm_free)
+#  define mm_realloc           MM_CAT(MM_PREFIX, mm_realloc)
+#  define mm_calloc            MM_CAT(MM_PREFIX, mm_calloc)
+#  define mm_malloc_batch      MM_CAT(MM_PREFIX, mm_malloc_batch)
+#  define mm_free_batch        MM_CAT(MM_PREFIX, mm_free_batch)
+#  define mm_usable_size       MM_CAT(MM_PREFIX, mm_usable_size)
+#  define mm_try_expand        MM_CAT(MM_PREFIX, mm_try_expand)
+#  define mm_memalign          MM_CAT(MM_PREFIX, mm_memalign)
+#  define mm_aligned_alloc     MM_CAT(MM_PREFIX, mm_aligned_alloc)
+#  define mm_posix_memalign    MM_CAT(MM_PREFIX, mm_posix_memalign)
+#  define mm_decay_stats       MM_CAT(MM_PREFIX, mm_decay_stats)
+#  define mm_decay_shutdown    MM_CAT(MM_PREFIX, mm_decay_shutdown)
+#endif
 
 #include "mm.h"
 #include "memlib.h"
 
 /********************** Team Info (fill for your course) **********************/
+#ifdef MM_PREFIX
+__attribute__((weak)) // 정책마다 컴파일된 mm.c가 모두 정의하므로 하나만 남긴다
+#endif
 team_t team = {
     /* Team name */
     "ateam",
@@ -73,11 +164,21 @@ team_t team = {
 };
 
 /*************************** Global configuration ****************************/
-/* single word (4) or double word (8) alignment */
-#define ALIGNMENT 8
+/*
+ * payload 정렬: 8 (기본) 또는 16 (-DALIGNMENT=16, x86-64 ABI의 malloc 정렬 - SSE/long double).
+ * 모든 블록 크기가 ALIGNMENT의 배수이고 첫 블록의 payload가 힙 시작(16B 정렬)에서 16B 뒤에 있으므로
+ * (패딩 + 프롤로그 헤더/푸터 + 첫 헤더) 모든 payload가 ALIGNMENT 경계에 놓인다.
+ * 헤더 하위 3비트는 크기가 8의 배수라는 점만 쓰므로 두 모드 모두 블록 형식은 같다.
+ */
+#ifndef ALIGNMENT
+#  define ALIGNMENT 8
+#endif
+#if ALIGNMENT != 8 && ALIGNMENT != 16
+#  error "ALIGNMENT must be 8 or 16"
+#endif
 
 /* rounds up to the nearest multiple of ALIGNMENT */
-#define ALIGN(size)     (((size) + (ALIGNMENT - 1)) & ~0x7) // 항상 8의 배수로 맞춤
+#define ALIGN(size)     (((size) + (ALIGNMENT - 1)) & ~(size_t)(ALIGNMENT - 1)) // ALIGNMENT의 배수로 맞춤
 #define SIZE_T_SIZE     (ALIGN(sizeof(size_t)))
 
 #define WSIZE 4                 /* word size (bytes) - 1워드 = 4B */
@@ -89,126 +190,758 @@ team_t team = {
 #define PUT(p, val)         (*(unsigned *)(p) = (val)) // 주소값에 해당 데이터 블럭 넣기 - 포인터 p가 가리키는 워드에 val 저장
 
 #define GET_SIZE(p)         (GET(p) & ~0x7) // header와 footer에서 size 추출 - 하위 3비트 제거하여 크기만 반환
-#define GET_ALLOC(p)        (GET(p) & 0x1) // header와 footer에서 alloc 추출 - 최하위 비트로 할당 여부 확인
+#define GET_ALLOC(p)        (GET(p) & 0x1) // header에서 alloc 추출 - 최하위 비트로 할당 여부 확인
+
+/*
+ * 헤더의 1번 비트는 "바로 앞 블록이 할당됨(prev-alloc)" 플래그다.
+ * 푸터는 가용 블록에만 있으므로, 앞 블록의 푸터(PREV_BLKP)는 이 비트가 0일 때만 읽을 수 있다.
+ * 블록의 할당 상태가 바뀌면 다음 블록 헤더의 이 비트도 함께 갱신해야 한다.
+ */
+#define PREV_ALLOC          0x2 // prev-alloc 플래그 비트
+#define GET_PREV_ALLOC(p)   (GET(p) & PREV_ALLOC) // header에서 앞 블록 할당 여부 추출
+#define SET_PREV_ALLOC(p)   PUT(p, GET(p) | PREV_ALLOC) // header p의 prev-alloc 비트 켜기 (앞 블록이 할당됨)
+#define CLR_PREV_ALLOC(p)   PUT(p, GET(p) & ~PREV_ALLOC) // header p의 prev-alloc 비트 끄기 (앞 블록이 가용됨)
+
+/* 헤더의 2번 비트는 "mmap으로 따로 매핑한 큰 블록" 표시다 (힙 블록의 헤더에서는 항상 0) */
+#define MMAPPED             0x4 // mmap 블록 플래그 비트
 
 #define HDRP(bp)            ((char *)(bp) - WSIZE) // 블록 포인터로부터 header 위치 계산 - payload 시작에서 한 워드 뒤로
-#define FTRP(bp)            ((char *)(bp) + GET_SIZE(HDRP(bp)) - DSIZE) // 블록 포인터로부터 footer 위치 계산 - payload에서 블록 크기만큼 이동 후 더블워드 뒤로
+#define FTRP(bp)            ((char *)(bp) + GET_SIZE(HDRP(bp)) - DSIZE) // 블록 포인터로부터 footer 위치 계산 - payload에서 블록 크기만큼 이동 후 더블워드 뒤로 (가용 블록만 footer를 가짐)
 
 #define NEXT_BLKP(bp)       ((char *)(bp) + GET_SIZE(HDRP(bp))) // 다음 블록의 payload 시작 주소 - 현재 블록 크기만큼 이동
-#define PREV_BLKP(bp)       ((char *)(bp) - GET_SIZE(((char *)(bp) - DSIZE))) // 현재 블록 바로 앞에 있는 블록의 payload 시작 주소 - 이전 블록의 푸터에서 크기를 읽어 역산
+#define PREV_BLKP(bp)       ((char *)(bp) - GET_SIZE(((char *)(bp) - DSIZE))) // 현재 블록 바로 앞에 있는 블록의 payload 시작 주소 - 이전 블록의 푸터에서 크기를 읽어 역산 (앞 블록이 가용일 때만 유효)
 
 #define MAX(x,y)            ((x) > (y) ? (x) : (y)) // 둘이 비교해서 큰거 반환
+#define MIN(x,y)            ((x) < (y) ? (x) : (y)) // 둘이 비교해서 작은거 반환
 
 /* ------------------------- Policy selection macros ------------------------- */
 #define POLICY_IMPLICIT_FF 1 // 암시적 가용 리스트 + first-fit 정책
 #define POLICY_IMPLICIT_NF 2 // 암시적 가용 리스트 + next-fit 정책  
 #define POLICY_EXPLICIT_FF 3 // 명시적 가용 리스트 + first-fit 정책
 #define POLICY_SEGREGATED_BF 4 // 분리 가용 리스트 + best-fit 정책
+#define POLICY_TLSF 5 // 2단계 분리 가용 리스트 (TLSF) + good-fit 정책
+#define POLICY_TREE_BF 6 // 분리 가용 리스트 + 큰 블록용 균형 트리 + best-fit 정책
+#define POLICY_BUDDY 7 // 이진 버디 시스템 (2의 거듭제곱 블록, 차수별 가용 리스트)
+#define POLICY_ADDRESS_FF 8 // 주소순 가용 블록 트리 + first-fit 정책
 
 #ifndef ALLOC_POLICY
 #define ALLOC_POLICY POLICY_EXPLICIT_FF // 기본값: 명시적 first-fit
 #endif
 
+/* 분리 가용 리스트 코드를 공유하는 정책 (TREE_BF는 큰 블록만 트리로 보낸다) */
+#define USES_SEGREGATED_LISTS (ALLOC_POLICY == POLICY_SEGREGATED_BF || ALLOC_POLICY == POLICY_TREE_BF)
+/* AA 트리 코드를 공유하는 정책 (TREE_BF는 (크기, 주소) 키, ADDRESS_FF는 주소 키) */
+#define USES_AA_TREE (ALLOC_POLICY == POLICY_TREE_BF || ALLOC_POLICY == POLICY_ADDRESS_FF)
+/* 가용 블록 payload에 이전/다음 링크를 두는 정책 */
+#define USES_FREE_LINKS (ALLOC_POLICY == POLICY_EXPLICIT_FF || USES_SEGREGATED_LISTS || ALLOC_POLICY == POLICY_TLSF || ALLOC_POLICY == POLICY_BUDDY)
+
 /* Common forward declarations */
 static void *extend_heap(size_t words); // 힙을 words만큼 확장하여 가용블록으로 초기화
 static void *coalesce(void *bp); // 인접한 가용 블록들과 병합
 static void *find_fit(size_t asize); // policy-specific - 적합한 가용 블록 찾기
 static void place(void *bp, size_t asize); // 블록에 요청 크기만큼 할당하고 나머지는 분할
 
-static char *heap_listp = NULL; /* prologue payload ptr - 프롤로그 블록의 payload 포인터 */
 
-/* -------------------- Explicit free list (policy hooks) -------------------- */
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-#  define PTRSIZE              (sizeof(void *)) // 포인터 크기 (보통 8바이트)
+/* ---------------------- Free-list links (policy hooks) --------------------- */
+/*
+ * 가용 블록 payload 앞부분의 이전/다음 링크 (명시적/분리/TLSF/버디 리스트가 공유).
+ * 기본은 포인터 두 개(8B씩)이고, -DMM_OFFSET_LINKS=1이면 힙 시작(link_base)으로부터의
+ * 32비트 오프셋 두 개(4B씩)로 저장해 최소 블록이 24B에서 16B(헤더 + 링크 둘 + 푸터)로 줄어든다.
+ * 오프셋 0은 NULL이다 (힙의 첫 워드는 패딩이라 어떤 블록의 payload도 아님). 대신 힙은 4GB를 넘을 수 없다.
+ * 링크가 없는 정책(암시적, 주소순 트리)에서는 아무 효과가 없다.
+ */
+#ifndef MM_OFFSET_LINKS
+#  define MM_OFFSET_LINKS      0 // 기본값: 포인터 링크
+#endif
+#if USES_FREE_LINKS && MM_OFFSET_LINKS
+#  define LINKSIZE             (sizeof(uint32_t)) // 링크 크기 4B
+#  define LINK_SPAN            ((size_t)1 << 32) // 오프셋으로 가리킬 수 있는 최대 힙 크기 4GB
+static char *link_base;        /* 오프셋의 원점 = mem_heap_lo() (mm_init에서 설정) */
+
+static inline char *link_ptr(uint32_t off) { return off ? link_base + off : NULL; } // 오프셋 -> 주소
+static inline uint32_t link_off(const void *p) { return p ? (uint32_t)((const char *)p - link_base) : 0; } // 주소 -> 오프셋
+
+#  define PREV_FREEP(bp)       link_ptr(*(uint32_t *)(bp)) // 가용 블록 payload의 첫 번째 링크 - 이전 가용 블록 주소
+#  define NEXT_FREEP(bp)       link_ptr(*(uint32_t *)((char *)(bp) + LINKSIZE)) // 가용 블록 payload의 두 번째 링크 - 다음 가용 블록 주소
+#  define SET_PREV(bp, p)      (*(uint32_t *)(bp) = link_off(p)) // 이전 가용 블록 링크 설정
+#  define SET_NEXT(bp, p)      (*(uint32_t *)((char *)(bp) + LINKSIZE) = link_off(p)) // 다음 가용 블록 링크 설정
+#elif USES_FREE_LINKS
+#  define LINKSIZE             (sizeof(void *)) // 포인터 크기 (보통 8바이트)
 #  define PREV_FREEP(bp)       (*(char **)(bp)) // 가용 블록 payload의 첫 번째 포인터 - 이전 가용 블록 주소
-#  define NEXT_FREEP(bp)       (*(char **)((char *)(bp) + PTRSIZE)) // 가용 블록 payload의 두 번째 포인터 - 다음 가용 블록 주소
+#  define NEXT_FREEP(bp)       (*(char **)((char *)(bp) + LINKSIZE)) // 가용 블록 payload의 두 번째 포인터 - 다음 가용 블록 주소
 #  define SET_PREV(bp, p)      (PREV_FREEP(bp) = (char *)(p)) // 이전 가용 블록 포인터 설정
 #  define SET_NEXT(bp, p)      (NEXT_FREEP(bp) = (char *)(p)) // 다음 가용 블록 포인터 설정
-static char *free_listp = NULL;       /* head of explicit free list - 명시적 가용 리스트의 머리 포인터 */
 #endif
 
-/* --------------------- Next-fit rover (policy hook) ------------------------ */
-#if ALLOC_POLICY == POLICY_IMPLICIT_NF
-static char *rover = NULL;            /* next-fit rover - next-fit용 탐색 시작 지점 포인터 */
+/* ---------------------- Size-ordered tree (policy hook) --------------------- */
+#if ALLOC_POLICY == POLICY_TREE_BF
+/*
+ * TREE_MIN_SIZE 이상인 가용 블록은 (size, 주소) 키로 정렬된 AA 트리에 들어간다.
+ * 노드는 가용 블록 payload 안에 저장: | left | right | level |
+ * AA 트리는 최악의 경우에도 높이가 O(log n)이므로 삽입/삭제/best-fit 모두 O(log n)이고,
+ * 같은 크기의 블록은 주소가 낮은 쪽이 먼저 선택된다 (결정적인 tie-breaking).
+ * 그보다 작은 블록은 분리 가용 리스트가 그대로 담당한다.
+ */
+#  ifndef TREE_MIN_LOG2
+#    define TREE_MIN_LOG2      10 // 트리로 보낼 최소 블록 크기 2^10 = 1024B
+#  endif
+#  define TREE_MIN_SIZE        ((size_t)1 << TREE_MIN_LOG2)
+#  ifndef SEG_BANDS
+#    define SEG_BANDS          (TREE_MIN_LOG2 - 4) // 분리 리스트는 16B ~ TREE_MIN_SIZE-1 까지만 담당
+#  endif
+// -DSEG_BANDS로 바꿔도 동작은 같다: TREE_MIN_SIZE 이상 구간의 리스트는 비어 있고, 그보다 적으면 마지막 클래스가 나머지를 맡음
+#endif
+
+/* ------------------- Address-ordered tree (policy hook) -------------------- */
+#if ALLOC_POLICY == POLICY_ADDRESS_FF
+/*
+ * 모든 가용 블록이 주소를 키로 하는 AA 트리에 들어간다 (TREE_BF와 같은 트리 코드).
+ * 노드마다 서브트리에서 가장 큰 블록 크기(TREE_MAX)를 함께 유지하므로, 주소가 가장 낮은
+ * asize 이상 블록(주소순 first-fit)을 루트에서 한 번 내려가며 찾는다.
+ * 노드는 가용 블록 payload 안에 저장: | left | right | level | max |
+ * LIFO 리스트와 달리 삽입 위치를 찾는 것도 트리 높이만큼이라 삽입/삭제/탐색 모두 O(log n).
+ */
+#  define TREE_MAX(bp)         (*(uint32_t *)((char *)(bp) + 2*sizeof(void *) + sizeof(unsigned))) // 서브트리 최대 블록 크기
+#endif
+
+/* 트리 노드 형식 (TREE_BF, ADDRESS_FF 공통) */
+#if USES_AA_TREE
+#  define TREE_LEFT(bp)        (*(char **)(bp)) // 왼쪽 자식 (키가 더 작은 블록)
+#  define TREE_RIGHT(bp)       (*(char **)((char *)(bp) + sizeof(void *))) // 오른쪽 자식 (키가 더 큰 블록)
+#  define TREE_LEVEL(bp)       (*(unsigned *)((char *)(bp) + 2*sizeof(void *))) // AA 트리 레벨 (리프 = 1)
 #endif
 
 /* ------------------- Segregated free lists (policy hooks) ------------------- */
-#if ALLOC_POLICY == POLICY_SEGREGATED_BF
-#  define PTRSIZE              (sizeof(void *)) // 포인터 크기 (보통 8바이트)
-#  define PREV_FREEP(bp)       (*(char **)(bp)) // 가용 블록 payload의 첫 번째 포인터 - 이전 가용 블록 주소
-#  define NEXT_FREEP(bp)       (*(char **)((char *)(bp) + PTRSIZE)) // 가용 블록 payload의 두 번째 포인터 - 다음 가용 블록 주소
-#  define SET_PREV(bp, p)      (PREV_FREEP(bp) = (char *)(p)) // 이전 가용 블록 포인터 설정
-#  define SET_NEXT(bp, p)      (NEXT_FREEP(bp) = (char *)(p)) // 다음 가용 블록 포인터 설정
+#if USES_SEGREGATED_LISTS
+/*
+ * 크기 클래스 구성: 2의 거듭제곱 구간(band) SEG_BANDS개를 다시 2^SEG_SUB_LOG2개로 선형 분할한다.
+ * 기본값(10 band, 분할 없음)은 기존과 동일하다:
+ *   Class 0: 16-31B, Class 1: 32-63B, ..., Class 8: 4096-8191B, Class 9: 8192B+
+ * 클래스 탐색은 비트맵으로 O(1)이므로 더 잘게 나눠도 빈 클래스 순회 비용이 없다. 예)
+ *   64 클래스 : -DSEG_BANDS=16 -DSEG_SUB_LOG2=2   (16B ~ 1MB+, 구간당 4개)
+ *   128 클래스: -DSEG_BANDS=16 -DSEG_SUB_LOG2=3   (16B ~ 1MB+, 구간당 8개)
+ */
+#  ifndef SEG_BANDS
+#    define SEG_BANDS          10 // 2의 거듭제곱 구간 개수 (마지막 구간은 그 이상 전부 포함)
+#  endif
+#  ifndef SEG_SUB_LOG2
+#    define SEG_SUB_LOG2       0  // 구간 하나를 2^SEG_SUB_LOG2개의 하위 클래스로 분할
+#  endif
+#  define SEG_MIN_LOG2         4  // 가장 작은 구간의 하한 2^4 = 16B
+#  if SEG_SUB_LOG2 > SEG_MIN_LOG2
+#    error "SEG_SUB_LOG2 must not exceed SEG_MIN_LOG2"
+#  endif
+#  define SEGREGATED_CLASSES   (SEG_BANDS << SEG_SUB_LOG2) // 분리 리스트 개수 (크기 클래스별)
+#  define SEG_BITMAP_WORDS     ((SEGREGATED_CLASSES + 63) / 64) // 비트맵 워드 수 (64클래스당 1워드)
+#endif
 
-#  define SEGREGATED_CLASSES   10 // 분리 리스트 개수 (크기 클래스별)
-static char *segregated_lists[SEGREGATED_CLASSES]; /* 크기별 분리 가용 리스트 배열 */
-
-// 크기 클래스 경계값들 (2^4=16, 2^5=32, 2^6=64, ..., 2^13=8192, 그 이상)
-// Class 0: 16-31B, Class 1: 32-63B, ..., Class 9: 8192B+
-#  define SIZE_CLASS_0_MIN     16
-#  define SIZE_CLASS_0_MAX     31
-#  define SIZE_CLASS_1_MIN     32
-#  define SIZE_CLASS_1_MAX     63
-#  define SIZE_CLASS_2_MIN     64
-#  define SIZE_CLASS_2_MAX     127
-#  define SIZE_CLASS_3_MIN     128
-#  define SIZE_CLASS_3_MAX     255
-#  define SIZE_CLASS_4_MIN     256
-#  define SIZE_CLASS_4_MAX     511
-#  define SIZE_CLASS_5_MIN     512
-#  define SIZE_CLASS_5_MAX     1023
-#  define SIZE_CLASS_6_MIN     1024
-#  define SIZE_CLASS_6_MAX     2047
-#  define SIZE_CLASS_7_MIN     2048
-#  define SIZE_CLASS_7_MAX     4095
-#  define SIZE_CLASS_8_MIN     4096
-#  define SIZE_CLASS_8_MAX     8191
-// Class 9: 8192B 이상
+/* ---------------------- TLSF free lists (policy hooks) --------------------- */
+#if ALLOC_POLICY == POLICY_TLSF
+/*
+ * 1단계(FL): 2의 거듭제곱 구간 floor(log2(size)), 2단계(SL): 구간을 2^TLSF_SL_LOG2개로 선형 분할.
+ * 두 단계 모두 비트맵을 두어 "요청 크기 이상인 비어있지 않은 리스트"를 find-first-set 두 번으로 찾는다.
+ * 리스트 순회가 없으므로 find_fit/insert/remove 모두 최악의 경우에도 O(1).
+ */
+#  ifndef TLSF_SL_LOG2
+#    define TLSF_SL_LOG2       4  // 2단계 분할 수 = 2^4 = 16 (구간당 오차 최대 1/16)
+#  endif
+#  define TLSF_SL_COUNT        (1 << TLSF_SL_LOG2)
+#  define TLSF_FL_SHIFT        4  // 1단계 0번 = 2^4 = 16B 구간
+#  define TLSF_FL_COUNT        (32 - TLSF_FL_SHIFT) // 헤더 size 필드(32비트)로 표현 가능한 모든 구간
+#  if TLSF_SL_LOG2 > TLSF_FL_SHIFT
+#    error "TLSF_SL_LOG2 must not exceed TLSF_FL_SHIFT"
+#  endif
 #endif
 
-/* ---------------------- MIN_BLOCK depends on policy ------------------------ */
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF || ALLOC_POLICY == POLICY_SEGREGATED_BF
-#  ifndef PTRSIZE
-#    define PTRSIZE (sizeof(void *))
+/* --------------------- Buddy free lists (policy hooks) --------------------- */
+#if ALLOC_POLICY == POLICY_BUDDY
+/*
+ * 모든 블록은 크기가 2^k (차수 k)이고, 블록 시작(헤더) 주소는 원점 buddy_base로부터 2^k의 배수다.
+ * 따라서 차수 k 블록의 버디는 (오프셋 XOR 2^k)에 있고, 병합은 버디 헤더 하나만 읽으면 된다.
+ * 원점은 (buddy_base + WSIZE)가 BUDDY_ORIGIN_ALIGN 경계가 되도록 잡으므로
+ * 그 크기 이상의 블록은 payload가 BUDDY_ORIGIN_ALIGN에 정렬된다 (슬랩 페이지로 바로 쓸 수 있음).
+ * 힙 끝은 2의 거듭제곱 정렬이 맞을 때까지 작은 블록으로 채운 뒤 늘린다.
+ */
+#  if MM_OFFSET_LINKS
+#    define BUDDY_MIN_ORDER    4  // 최소 블록 2^4 = 16B (헤더 + 오프셋 링크 둘이 들어가는 가장 작은 2의 거듭제곱)
+#  else
+#    define BUDDY_MIN_ORDER    5  // 최소 블록 2^5 = 32B (헤더 + 두 포인터가 들어가는 가장 작은 2의 거듭제곱)
+#  endif
+#  define BUDDY_ORDERS         32 // 헤더 size 필드(32비트)로 표현 가능한 모든 차수
+#  define BUDDY_ORIGIN_ALIGN   ((size_t)1 << 12) // 원점 정렬 (4KB)
+#  define BUDDY_END()          ((char *)mem_heap_hi() + 1 - WSIZE) // 에필로그 헤더 = 다음에 붙일 블록의 헤더 자리
+#  define BUDDY_ORDER(size)    (31 - __builtin_clz((unsigned)(size))) // 2의 거듭제곱 크기의 차수
+#  define BUDDY_ROUND(n)       ((n) <= MIN_BLOCK ? (size_t)MIN_BLOCK : (size_t)1 << (32 - __builtin_clz((unsigned)(n) - 1))) // n 이상인 가장 작은 블록 크기
+#  ifdef MM_THREADS
+#    error "POLICY_BUDDY does not support MM_THREADS (buddies may straddle arena segments)"
 #  endif
-#  define MIN_BLOCK ALIGN(WSIZE /*hdr*/ + 2*PTRSIZE /*prev,next*/ + WSIZE /*ftr*/) // 명시적/분리: 헤더(4) + 이전포인터(8) + 다음포인터(8) + 푸터(4) = 대략 24B
+#endif
+
+/* ---------------------- MIN_BLOCK depends on policy ------------------------ */
+#if ALLOC_POLICY == POLICY_EXPLICIT_FF || USES_SEGREGATED_LISTS || ALLOC_POLICY == POLICY_TLSF
+#  define MIN_BLOCK ALIGN(WSIZE /*hdr*/ + 2*LINKSIZE /*prev,next*/ + WSIZE /*ftr*/) // 명시적/분리: 헤더(4) + 이전링크(8) + 다음링크(8) + 푸터(4) = 대략 24B (오프셋 링크면 16B)
+#elif ALLOC_POLICY == POLICY_ADDRESS_FF
+#  define MIN_BLOCK ALIGN(WSIZE + 2*sizeof(void *) + sizeof(unsigned) + sizeof(uint32_t) + WSIZE) // 주소순 트리: 헤더(4) + 트리 노드(24) + 푸터(4) = 32B
+#elif ALLOC_POLICY == POLICY_BUDDY
+#  define MIN_BLOCK (1 << BUDDY_MIN_ORDER) // 버디: 최소 차수 블록 32B (오프셋 링크면 16B)
 #else
 #  define MIN_BLOCK (2*DSIZE) // 암시적: 헤더(4) + 푸터(4) + 최소 payload(8) = 16B
 #endif
 
+/* ---------------------- Policy hooks used by common code -------------------- */
+/*
+ * coalesce / place / trim_top / realloc 같은 공통 코드는 가용 자료구조를 아래 훅으로만 다룬다.
+ * 새 정책은 여기서 훅을 연결하고, 자기 절에 삽입/삭제 함수와 find_fit을 정의하면 된다.
+ * (버디는 블록 형식이 달라 coalesce와 place의 분할 방식만 따로 가진다.)
+ *   FREE_INSERT(bp)         가용 블록 bp를 가용 자료구조에 넣음
+ *   FREE_REMOVE(bp)         가용 블록 bp를 가용 자료구조에서 뺌
+ *   FIT_PLACED(bp)          블록을 할당한 직후 다음 탐색 시작점을 bp로 (next-fit)
+ *   FIT_MOVED(lo, hi, to)   탐색 시작점이 [lo, hi] 안이면 to로 옮김 (병합/흡수/trim으로 사라지는 블록)
+ */
+#if ALLOC_POLICY == POLICY_EXPLICIT_FF
+#  define FREE_INSERT(bp)      insert_free_block(bp)
+#  define FREE_REMOVE(bp)      remove_free_block(bp)
+#elif USES_SEGREGATED_LISTS
+#  define FREE_INSERT(bp)      insert_segregated_block(bp)
+#  define FREE_REMOVE(bp)      remove_segregated_block(bp)
+#elif ALLOC_POLICY == POLICY_TLSF
+#  define FREE_INSERT(bp)      insert_tlsf_block(bp)
+#  define FREE_REMOVE(bp)      remove_tlsf_block(bp)
+#elif ALLOC_POLICY == POLICY_ADDRESS_FF
+#  define FREE_INSERT(bp)      insert_address_block(bp)
+#  define FREE_REMOVE(bp)      remove_address_block(bp)
+#elif ALLOC_POLICY == POLICY_BUDDY
+#  define FREE_INSERT(bp)      insert_buddy_block(bp)
+#  define FREE_REMOVE(bp)      remove_buddy_block(bp)
+#else /* 암시적: 힙 자체가 가용 자료구조이므로 할 일 없음 */
+#  define FREE_INSERT(bp)      ((void)(bp))
+#  define FREE_REMOVE(bp)      ((void)(bp))
+#endif
+#if ALLOC_POLICY == POLICY_IMPLICIT_NF
+#  define FIT_PLACED(bp)       (arena->rover = (char *)(bp))
+#  define FIT_MOVED(lo, hi, to) \
+    do { if (arena->rover >= (char *)(lo) && arena->rover <= (char *)(hi)) arena->rover = (char *)(to); } while (0)
+#else
+#  define FIT_PLACED(bp)       ((void)0)
+#  define FIT_MOVED(lo, hi, to) ((void)0)
+#endif
+
+/************************ Allocator state (per arena) *************************/
+/*
+ * 할당기의 모든 상태는 arena_t 하나에 모여 있다. 기본 빌드에서는 아레나가 하나뿐이고
+ * arena는 그것을 가리키는 상수 포인터라 전역 변수와 같은 코드가 나온다.
+ *
+ * MM_THREADS 빌드 (make CFLAGS+=' -DMM_THREADS -pthread')
+ *   - 스레드는 처음 호출할 때 MM_ARENAS개 아레나 중 하나에 라운드로빈으로 묶인다.
+ *   - 아레나마다 자기 가용 리스트와 락, 그리고 memlib에서 떼어 온 자기 세그먼트들을 가진다.
+ *     세그먼트는 | pad | prologue | blocks ... | epilogue | 형태의 독립된 미니 힙이라
+ *     병합이 다른 아레나의 블록으로 넘어가지 않는다.
+ *   - memlib 힙은 ARENA_GRANULE 단위로 소유 아레나가 기록되어(arena_owner),
+ *     mm_free/mm_realloc은 블록 주소만으로 소유 아레나를 찾아 그 아레나의 락 아래서 처리한다.
+ *   - 다른 아레나 소유 블록을 해제할 때는 락 대신 그 아레나의 remote_free 스택에
+ *     CAS 한 번으로 넣고, 소유 아레나가 다음 malloc 때 락 아래서 한꺼번에 병합한다 (drain_remote_frees).
+ *   - 힙을 순회하는 암시적 정책은 세그먼트를 건너뛸 수 없으므로 가용 리스트 정책만 지원한다.
+ */
+#ifdef MM_THREADS
+#  include <pthread.h>
+#  if ALLOC_POLICY == POLICY_IMPLICIT_FF || ALLOC_POLICY == POLICY_IMPLICIT_NF
+#    error "MM_THREADS requires a free-list policy (explicit, segregated, TLSF or tree)"
+#  endif
+#  ifndef MM_ARENAS
+#    define MM_ARENAS          8  // 아레나 개수 (스레드 수가 더 많으면 아레나를 공유)
+#  endif
+#  if MM_ARENAS > 255
+#    error "MM_ARENAS must fit in arena_owner[] entries (<= 255)"
+#  endif
+#  define ARENA_GRANULE_LOG2   12 // 소유 아레나 기록 단위 2^12 = 4KB
+#  define ARENA_GRANULE        ((size_t)1 << ARENA_GRANULE_LOG2)
+#  ifndef ARENA_MAX_GRANULES
+#    define ARENA_MAX_GRANULES (1 << 16) // 소유 기록 가능한 최대 힙 = 64K * 4KB = 256MB
+#  endif
+#  if USES_FREE_LINKS && MM_OFFSET_LINKS && ARENA_MAX_GRANULES > (1 << (32 - ARENA_GRANULE_LOG2))
+#    error "MM_OFFSET_LINKS needs ARENA_MAX_GRANULES * 4KB <= 4GB"
+#  endif
+static void drain_remote_frees(void); // 다른 스레드가 해제한 블록 병합 ("Remote frees" 절)
+#else
+#  define drain_remote_frees() ((void)0) // 단일 스레드: 다른 스레드의 해제가 없음
+#endif
+
+/* 스레드 캐시(tcache) 사용 여부 - 아래 "Thread cache" 절 참고 */
+#ifndef MM_TCACHE
+#  ifdef MM_THREADS
+#    define MM_TCACHE          1
+#  else
+#    define MM_TCACHE          0 // 단일 스레드 기본값: 꺼짐 (캐시에 남은 블록만큼 util이 떨어짐)
+#  endif
+#endif
+
+#if MM_TCACHE
+static unsigned heap_gen;          /* mm_init마다 증가 - 스레드 캐시의 세대와 다르면 옛 힙의 블록 */
+#  ifdef MM_THREADS
+static pthread_key_t tcache_key;   /* 스레드 종료 시 캐시를 비우기 위한 키 */
+static void tcache_thread_exit(void *p); // 스레드 종료 시 캐시 반환 (pthread key 소멸자)
+#  endif
+#endif
+
+/* 작은 블록의 해제를 미뤄 두는 quick list 사용 여부 - 아래 "Quick lists" 절 참고 */
+#ifndef MM_QUICK
+#  if MM_TCACHE
+#    define MM_QUICK           0 // 스레드 캐시가 이미 작은 블록의 병합을 미룸
+#  else
+#    define MM_QUICK           1 // 단일 스레드 기본값: 켜짐 (-DMM_QUICK=0이면 해제마다 바로 병합)
+#  endif
+#endif
+#if MM_QUICK
+#  ifndef QUICK_MAX_SIZE
+#    define QUICK_MAX_SIZE     1024 // quick list에 넣을 최대 블록 크기 (헤더 포함)
+#  endif
+#  ifndef QUICK_CAP
+#    define QUICK_CAP          256 // 크기별 최대 보관 블록 수 - 넘치면 그 크기 리스트를 한꺼번에 병합
+#  endif
+#  define QUICK_BINS           (QUICK_MAX_SIZE / DSIZE + 1) // 블록 크기 8B 단위, 크기가 정확히 같은 블록끼리
+#  define QUICK_NEXT(bp)       (*(char **)(bp)) // quick list 안 블록의 payload 첫 워드 - 다음 블록
+static int quick_drain(void); // 보관 중인 블록을 모두 병합 ("Quick lists" 절)
+#endif
+
+/* 큰 요청용 mmap 경로 사용 여부 - 아래 "Large blocks (mmap)" 절 참고 */
+#ifndef MM_MMAP
+#  define MM_MMAP              1 // 기본값: 켜짐 (-DMM_MMAP=0이면 모든 요청을 힙에서)
+#endif
+#if MM_MMAP && !defined(MMAP_THRESHOLD)
+#  define MMAP_THRESHOLD       (128 * 1024) // 이 크기 이상의 요청은 자기 매핑을 받는다 (바이트)
+#endif
+
+/* 가용 페이지를 백그라운드 워커가 시간에 따라 반납할지 여부 - 아래 "Decay purging" 절 참고 */
+#ifndef MM_DECAY
+#  define MM_DECAY             0 // 기본값: 꺼짐 (-DMM_DECAY=1, MM_THREADS 빌드 전용)
+#endif
+#if MM_DECAY
+#  ifndef MM_THREADS
+#    error "MM_DECAY requires MM_THREADS (the purge worker takes arena locks)"
+#  endif
+#  ifndef DECAY_MS
+#    define DECAY_MS           10000 // 해제된 페이지가 모두 반납되기까지 걸리는 시간 (밀리초, 실행 시 MM_DECAY_MS로 변경)
+#  endif
+#  define DECAY_EPOCHS         200   // 감쇠 곡선의 구간 수 (워커는 decay_ms / DECAY_EPOCHS마다 깨어남)
+#  define DECAY_PAGE           ARENA_GRANULE // 반납/상주 여부를 세는 페이지 단위 (4KB)
+static pthread_mutex_t decay_lock = PTHREAD_MUTEX_INITIALIZER; /* 워커의 한 번 순회와 mm_init을 직렬화 */
+static void decay_reset(void); // 감쇠 상태 초기화 + 워커 시작 ("Decay purging" 절)
+#endif
+
+/* 힙 끝 반납(trim)과 큰 가용 블록의 페이지 반납 여부 - 아래 "Heap trimming" 절 참고 */
+#ifndef MM_TRIM
+#  define MM_TRIM              1 // 기본값: 켜짐 (-DMM_TRIM=0이면 한 번 늘린 힙을 계속 붙잡음)
+#endif
+#if MM_TRIM
+#  ifndef TRIM_THRESHOLD
+#    define TRIM_THRESHOLD     (128 * 1024) // 힙 끝 가용 블록이 이 크기 이상이면 brk를 내린다 (바이트)
+#  endif
+#  define TRIM_KEEP            CHUNKSIZE   // brk를 내린 뒤에도 힙 끝에 남겨 둘 가용 블록 크기 (곧바로 다시 늘리지 않도록)
+#  ifndef DECOMMIT_THRESHOLD
+#    if MM_DECAY
+#      define DECOMMIT_THRESHOLD ((size_t)-1) // 내부 페이지 반납은 decay 워커가 맡는다
+#    else
+#      define DECOMMIT_THRESHOLD (64 * 1024) // 이 크기 이상의 블록을 해제하면 그 페이지를 OS에 돌려준다
+#    endif
+#  endif
+#endif
+#if MM_TRIM || MM_DECAY
+#  define DECOMMIT_SKIP        (4*DSIZE)   // payload 앞부분(리스트/트리 링크)은 반납하지 않음
+#endif
+
+/* 반복해서 커지는 블록에 여유 공간을 예약할지 여부 - 아래 "Realloc growth reservations" 절 참고 */
+#ifndef MM_GROW
+#  if ALLOC_POLICY == POLICY_BUDDY
+#    define MM_GROW            0 // 버디: 블록이 이미 2의 거듭제곱으로 올려져 있고 buddy_resize가 제자리 확장
+#  else
+#    define MM_GROW            1 // 기본값: 켜짐 (-DMM_GROW=0이면 요청 크기만큼만)
+#  endif
+#endif
+#if MM_GROW
+#  if ALLOC_POLICY == POLICY_BUDDY
+#    error "MM_GROW is not supported with POLICY_BUDDY"
+#  endif
+#  define GROW_HIST            64 // 아레나별 확장 기록 칸 수 (주소 해시, 충돌하면 덮어씀)
+#  ifndef GROW_AFTER
+#    define GROW_AFTER         3  // 이 횟수만큼 연달아 커진 블록부터 여유를 예약
+#  endif
+#  ifndef GROW_MIN
+#    define GROW_MIN           2048 // 이보다 작은 블록은 기록하지 않음 (tcache/슬랩 크기보다 커야 함)
+#  endif
+#  define GROW_RESERVE(asize)  ALIGN((asize) + (asize) / 2) // 예약 크기: 요청의 1.5배 (기하급수적 증가)
+static void grow_forget(void *bp); // 해제되는 블록의 확장 기록 삭제 ("Realloc growth reservations" 절)
+static int grow_reclaim(void);     // 예약된 여유를 모두 회수
+#endif
+
+/* 힙 확장 크기를 할당 속도와 힙 크기에 맞춰 조절할지 여부 - 아래 extend_fit 참고 */
+#ifndef MM_ADAPT_EXTEND
+#  if ALLOC_POLICY == POLICY_BUDDY
+#    define MM_ADAPT_EXTEND    0 // 버디: extend_heap이 요청을 2의 거듭제곱 블록으로만 붙임
+#  else
+#    define MM_ADAPT_EXTEND    1 // 기본값: 켜짐 (-DMM_ADAPT_EXTEND=0이면 항상 MAX(asize, CHUNKSIZE))
+#  endif
+#endif
+#if MM_ADAPT_EXTEND
+#  if ALLOC_POLICY == POLICY_BUDDY
+#    error "MM_ADAPT_EXTEND is not supported with POLICY_BUDDY"
+#  endif
+#  ifndef EXTEND_BURST
+#    define EXTEND_BURST       16 // 지난 확장분을 이 횟수 이상의 할당이 나눠 썼으면 다음 확장 단위를 두 배로
+#  endif
+#  ifndef EXTEND_HEAP_SHIFT
+#    define EXTEND_HEAP_SHIFT  7  // 확장 단위 상한 = 현재 힙 크기 / 2^EXTEND_HEAP_SHIFT (기하급수적 증가의 상한)
+#  endif
+#  ifndef EXTEND_TOP_SHIFT
+#    define EXTEND_TOP_SHIFT   9  // 힙 끝 블록을 realloc으로 늘릴 때 최소 확장 = 현재 힙 크기 / 2^EXTEND_TOP_SHIFT
+#  endif
+#endif
+
+/* 작은 객체용 슬랩 사용 여부 - 아래 "Slab allocator" 절 참고 */
+#ifndef MM_SLAB
+#  define MM_SLAB              1 // 기본값: 켜짐 (-DMM_SLAB=0이면 모든 요청을 블록으로)
+#endif
+
+#if MM_SLAB
+#  define SLAB_SIZE_LOG2       12 // 슬랩 하나 = 페이지 하나 2^12 = 4KB (포인터를 마스킹하면 슬랩 헤더)
+#  define SLAB_SIZE            ((size_t)1 << SLAB_SIZE_LOG2)
+#  ifndef SLAB_MAX_OBJ
+#    define SLAB_MAX_OBJ       256 // 슬랩이 맡는 최대 요청 크기 (바이트)
+#  endif
+#  define SLAB_CLASSES         (SLAB_MAX_OBJ / ALIGNMENT) // 객체 크기 ALIGNMENT 단위 클래스 (8, 16, ..., SLAB_MAX_OBJ)
+#  define SLAB_MAP_WORDS       8  // 빈 칸 비트맵 워드 수 (8B 객체도 512칸 이하)
+#  ifndef SLAB_MAX_PAGES
+#    define SLAB_MAX_PAGES     (1 << 16) // 슬랩 여부를 기록할 수 있는 최대 힙 = 64K * 4KB = 256MB
+#  endif
+
+typedef struct slab {
+    struct slab *next;             /* 같은 클래스에서 빈 칸이 남은 슬랩 리스트 */
+    struct slab *prev;
+    uint16_t obj_size;             /* 칸 크기 (ALIGNMENT의 배수, 객체마다 헤더/푸터 없음) */
+    uint16_t nobjs;                /* 슬랩의 전체 칸 수 */
+    uint16_t nfree;                /* 빈 칸 수 */
+    uint16_t cls;                  /* 크기 클래스 */
+    uint64_t free_map[SLAB_MAP_WORDS]; /* i번 비트 = i번 칸이 비어 있음 */
+} slab_t;
+
+#  define SLAB_HDR_SIZE        ALIGN(sizeof(slab_t)) // 첫 칸의 오프셋
+
+static uint64_t slab_pages[SLAB_MAX_PAGES / 64]; /* 힙 페이지별 "슬랩 페이지" 비트 (mem_heap_lo 기준) */
+#endif
+
+typedef struct arena {
+    char *heap_listp;        /* prologue payload ptr - 프롤로그 블록의 payload 포인터 (첫 세그먼트) */
+#if ALLOC_POLICY == POLICY_EXPLICIT_FF
+    char *free_listp;        /* head of explicit free list - 명시적 가용 리스트의 머리 포인터 */
+#elif ALLOC_POLICY == POLICY_IMPLICIT_NF
+    char *rover;             /* next-fit rover - next-fit용 탐색 시작 지점 포인터 */
+#elif USES_SEGREGATED_LISTS
+    char *segregated_lists[SEGREGATED_CLASSES]; /* 크기별 분리 가용 리스트 배열 */
+    uint64_t seg_bitmap[SEG_BITMAP_WORDS];      /* 비어있지 않은 클래스 비트맵 - i번 비트 = segregated_lists[i] != NULL */
+#  if ALLOC_POLICY == POLICY_TREE_BF
+    char *tree_root;         /* 큰 가용 블록 트리의 루트 */
+#  endif
+#elif ALLOC_POLICY == POLICY_ADDRESS_FF
+    char *tree_root;         /* 주소순 가용 블록 트리의 루트 */
+#elif ALLOC_POLICY == POLICY_TLSF
+    uint32_t tlsf_fl_bitmap;                       /* i번 비트 = i번 1단계 구간에 비어있지 않은 리스트가 있음 */
+    uint32_t tlsf_sl_bitmap[TLSF_FL_COUNT];        /* j번 비트 = tlsf_lists[i][j]가 비어있지 않음 */
+    char *tlsf_lists[TLSF_FL_COUNT][TLSF_SL_COUNT]; /* 2단계 분리 가용 리스트 머리 포인터 */
+#elif ALLOC_POLICY == POLICY_BUDDY
+    char *buddy_base;        /* 버디 주소 계산의 원점 (힙 시작보다 앞일 수 있는 가상 주소) */
+    char *buddy_lo;          /* 첫 블록의 헤더 주소 - 이보다 앞의 버디는 존재하지 않음 */
+    uint32_t buddy_bitmap;   /* k번 비트 = buddy_lists[k]가 비어있지 않음 */
+    char *buddy_lists[BUDDY_ORDERS]; /* 차수별 가용 리스트 머리 포인터 */
+#endif
+#ifdef MM_THREADS
+    pthread_mutex_t lock;    /* 아레나 락 - 이 아레나의 블록/리스트는 이 락 아래서만 변경 */
+    char *top;               /* 현재 세그먼트의 끝 (에필로그 다음 주소), 세그먼트가 없으면 NULL */
+    char *remote_free;       /* 다른 스레드가 해제한 블록의 lock-free 스택 (MPSC, payload 첫 워드로 연결) */
+#endif
+#if MM_DECAY
+    size_t decay_new;                   /* 워커가 마지막으로 깨어난 뒤 해제된 페이지 수 */
+    size_t decay_backlog[DECAY_EPOCHS]; /* 구간별 해제 페이지 수 ([0]이 가장 최근 구간) */
+    size_t decay_dirty;                 /* 가용 블록 안 상주 페이지 수 추정치 (마지막 순회 결과 + 이후 해제분) */
+#endif
+#if MM_SLAB
+    slab_t *slabs[SLAB_CLASSES]; /* 클래스별 빈 칸이 남은 슬랩 리스트 (가득 찬 슬랩은 빠짐) */
+#endif
+#if MM_QUICK
+    char *quick[QUICK_BINS];          /* 크기별 quick list 머리 (payload 첫 워드로 연결, 헤더는 할당 상태) */
+    unsigned quick_len[QUICK_BINS];   /* 크기별 보관 블록 수 */
+    unsigned quick_total;             /* 전체 보관 블록 수 (0이면 drain 생략) */
+#endif
+#if MM_ADAPT_EXTEND
+    size_t extend_chunk;         /* 다음 힙 확장의 최소 크기 (CHUNKSIZE부터 두 배씩) */
+    unsigned long nallocs;       /* 이 아레나에서 블록을 할당한 횟수 */
+    unsigned long extend_mark;   /* 마지막 힙 확장 때의 nallocs */
+#endif
+#if MM_GROW
+    struct {
+        char *bp;                /* 기록된 블록 (NULL이면 빈 칸) */
+        uint32_t grows;          /* 연달아 커진 횟수 */
+        uint32_t asize;          /* 마지막으로 요청된 블록 크기 - 이를 넘는 부분이 예약된 여유 */
+    } grow_hist[GROW_HIST];      /* 반복해서 커지는 블록 기록 (이 아레나 소유 블록만) */
+#endif
+} arena_t;
+
+#ifdef MM_THREADS
+static arena_t arenas[MM_ARENAS];                     /* 모든 아레나 */
+static __thread arena_t *arena;                       /* 이 스레드가 지금 작업 중인 아레나 (락을 잡은 상태) */
+static __thread arena_t *home_arena;                  /* 이 스레드가 묶인 아레나 (malloc이 사용) */
+static unsigned next_arena;                           /* 다음 스레드에게 줄 아레나 번호 */
+static uint8_t arena_owner[ARENA_MAX_GRANULES];       /* granule별 소유 아레나 번호 */
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER; /* memlib(mem_sbrk) 보호 */
+static pthread_once_t arena_once = PTHREAD_ONCE_INIT;
+
+#  define ARENA_ENTER(a)  (arena = (a), pthread_mutex_lock(&arena->lock)) // 아레나를 현재 아레나로 잡고 락
+#  define ARENA_LEAVE()   pthread_mutex_unlock(&arena->lock)             // 현재 아레나 락 해제
+#  define HEAP_LOCK()     pthread_mutex_lock(&heap_lock)                 // memlib 호출 보호
+#  define HEAP_UNLOCK()   pthread_mutex_unlock(&heap_lock)
+#else
+static arena_t main_arena;                            /* 유일한 아레나 */
+static arena_t *const arena = &main_arena;            /* 현재 아레나 (상수 - 전역 변수 접근과 동일) */
+#  define ARENA_ENTER(a)  ((void)0)
+#  define ARENA_LEAVE()   ((void)0)
+#  define HEAP_LOCK()     ((void)0)
+#  define HEAP_UNLOCK()   ((void)0)
+#endif
+
 /****************************** mm_init / extend ******************************/
+/*
+ * init_free_lists - 현재 아레나의 가용 블록 자료구조를 빈 상태로 초기화
+ */
+static void init_free_lists(void)
+{
+#if ALLOC_POLICY == POLICY_EXPLICIT_FF
+    arena->free_listp = NULL; // 명시적 가용 리스트 초기화 - 빈 리스트로 시작
+#elif USES_SEGREGATED_LISTS
+    // 분리 가용 리스트 초기화 - 모든 크기 클래스를 빈 리스트로 시작
+    for (int i = 0; i < SEGREGATED_CLASSES; i++) {
+        arena->segregated_lists[i] = NULL;
+    }
+    memset(arena->seg_bitmap, 0, sizeof(arena->seg_bitmap)); // 모든 클래스가 비어 있음
+#  if ALLOC_POLICY == POLICY_TREE_BF
+    arena->tree_root = NULL; // 큰 블록 트리도 비움
+#  endif
+#elif ALLOC_POLICY == POLICY_ADDRESS_FF
+    arena->tree_root = NULL; // 주소순 트리를 비움
+#elif ALLOC_POLICY == POLICY_TLSF
+    // TLSF 초기화 - 두 단계 비트맵과 모든 리스트를 비움
+    arena->tlsf_fl_bitmap = 0;
+    memset(arena->tlsf_sl_bitmap, 0, sizeof(arena->tlsf_sl_bitmap));
+    memset(arena->tlsf_lists, 0, sizeof(arena->tlsf_lists));
+#elif ALLOC_POLICY == POLICY_BUDDY
+    // 버디 초기화 - 모든 차수 리스트를 비움
+    arena->buddy_bitmap = 0;
+    memset(arena->buddy_lists, 0, sizeof(arena->buddy_lists));
+#endif
+#if MM_SLAB
+    memset(arena->slabs, 0, sizeof(arena->slabs)); // 슬랩 없음
+#endif
+#if MM_GROW
+    memset(arena->grow_hist, 0, sizeof(arena->grow_hist)); // 확장 기록 없음
+#endif
+#if MM_QUICK
+    memset(arena->quick, 0, sizeof(arena->quick)); // 미뤄 둔 해제 없음
+    memset(arena->quick_len, 0, sizeof(arena->quick_len));
+    arena->quick_total = 0;
+#endif
+#if MM_ADAPT_EXTEND
+    arena->extend_chunk = CHUNKSIZE; // 확장 단위는 기본 크기부터
+    arena->nallocs = arena->extend_mark = 0;
+#endif
+}
+
+#ifdef MM_THREADS
+/*
+ * init_arena_locks - 아레나 락 초기화 (프로세스에서 한 번만)
+ */
+static void init_arena_locks(void)
+{
+    for (int i = 0; i < MM_ARENAS; i++)
+        pthread_mutex_init(&arenas[i].lock, NULL);
+#  if MM_TCACHE
+    pthread_key_create(&tcache_key, tcache_thread_exit);
+#  endif
+}
+
+/*
+ * thread_arena - 이 스레드가 묶인 아레나 반환 (처음 호출 시 라운드로빈으로 배정)
+ */
+static inline arena_t *thread_arena(void)
+{
+    if (home_arena == NULL)
+        home_arena = &arenas[__atomic_fetch_add(&next_arena, 1, __ATOMIC_RELAXED) % MM_ARENAS];
+    return home_arena;
+}
+
+/*
+ * arena_of - 블록 주소가 속한 granule의 소유 아레나 반환
+ */
+static inline arena_t *arena_of(void *bp)
+{
+    size_t off = (size_t)((char *)bp - (char *)mem_heap_lo());
+    return &arenas[arena_owner[off >> ARENA_GRANULE_LOG2]];
+}
+
+/*
+ * arena_sbrk - 현재 아레나의 힙을 incr바이트 늘리고, 늘어난 영역의 시작(옛 에필로그 바로 다음)을 반환
+ * 아레나의 에필로그가 memlib 힙의 맨 끝이면 그 자리에서 늘린다 (단일 스레드에서는 항상 이 경우).
+ * 다른 아레나가 그 위를 차지했으면 granule 경계에서 새 세그먼트를 시작하고
+ * 그 앞에 프롤로그와 임시 에필로그를 놓아 extend_heap이 평소처럼 동작하게 한다.
+ */
+static void *arena_sbrk(size_t incr)
+{
+    char *bp = (void *)-1;
+    char *lo = mem_heap_lo();
+
+    pthread_mutex_lock(&heap_lock);
+    char *brk = (char *)mem_heap_hi() + 1; // memlib 힙의 현재 끝
+    size_t pad = 0, total = incr;
+    if (arena->top != brk) { // 새 세그먼트: granule 경계로 패딩 + 패딩워드/프롤로그/에필로그 4워드
+        pad = (ARENA_GRANULE - ((size_t)(brk - lo) & (ARENA_GRANULE - 1))) & (ARENA_GRANULE - 1);
+        total = pad + 4*WSIZE + incr;
+    }
+    // 소유 기록 범위를 넘는 힙은 줄 수 없음
+    if ((size_t)(brk - lo) + total <= (size_t)ARENA_MAX_GRANULES << ARENA_GRANULE_LOG2)
+        bp = mem_sbrk((int)total);
+
+    if (bp != (void *)-1) {
+        if (arena->top != brk) {
+            char *seg = bp + pad;
+            PUT(seg, 0);                                  /* alignment padding */
+            PUT(seg + (1*WSIZE), PACK(DSIZE, 1));         /* prologue header */
+            PUT(seg + (2*WSIZE), PACK(DSIZE, 1));         /* prologue footer */
+            PUT(seg + (3*WSIZE), PACK(0, PREV_ALLOC | 1)); /* epilogue header - extend_heap이 새 블록 헤더로 덮어씀 */
+            if (arena->heap_listp == NULL) arena->heap_listp = seg + (2*WSIZE); // 아레나의 첫 세그먼트
+            bp = seg + (4*WSIZE);
+        }
+        arena->top = (char *)mem_heap_hi() + 1;
+        // 새로 얻은 범위의 granule들을 이 아레나 소유로 기록
+        size_t first = (size_t)(bp - lo) >> ARENA_GRANULE_LOG2;
+        size_t last = (size_t)(arena->top - 1 - lo) >> ARENA_GRANULE_LOG2;
+        memset(&arena_owner[first], (int)(arena - arenas), last - first + 1);
+    }
+    pthread_mutex_unlock(&heap_lock);
+    return bp;
+}
+
+/*
+ * heap_top - end(세그먼트의 에필로그 다음 주소)가 memlib 힙의 끝인지 - 그래야 arena_sbrk가 그 자리에서 늘린다
+ */
+static inline int heap_top(char *end)
+{
+    pthread_mutex_lock(&heap_lock);
+    int top = (end == (char *)mem_heap_hi() + 1);
+    pthread_mutex_unlock(&heap_lock);
+    return top;
+}
+#else
+#  if USES_FREE_LINKS && MM_OFFSET_LINKS
+/*
+ * arena_sbrk - 단일 아레나: memlib 힙이 곧 아레나 힙. 오프셋 링크로 가리킬 수 없는 크기(4GB)로는 늘리지 않는다
+ */
+static inline void *arena_sbrk(size_t incr)
+{
+    if (mem_heapsize() + incr > LINK_SPAN)
+        return (void *)-1;
+    return mem_sbrk((int)incr);
+}
+#  else
+#    define arena_sbrk(incr)  mem_sbrk(incr) // 단일 아레나: memlib 힙이 곧 아레나 힙
+#  endif
+#  define heap_top(end)     1              // 단일 아레나: 에필로그가 곧 memlib 힙의 끝
+#endif
+
+/*
+ * heap_end - 현재 아레나 힙의 끝(에필로그 다음 주소). extend_heap이 그 자리에서
+ * 늘릴 수 없으면(세그먼트가 없거나 memlib 힙의 끝이 아니면) NULL
+ */
+static inline char *heap_end(void)
+{
+#ifdef MM_THREADS
+    char *end = arena->top; // 현재 세그먼트의 끝
+    return (end != NULL && heap_top(end)) ? end : NULL;
+#else
+    return (char *)mem_heap_hi() + 1;
+#endif
+}
+
 /*
  * mm_init - initialize the malloc package. 말록 패키지 초기화
  * 힙을 초기화하고 프롤로그/에필로그 블록을 생성한다.
+ * MM_THREADS 빌드에서는 모든 아레나를 비우며, 다른 스레드가 할당기를 쓰는 중에 호출하면 안 된다.
  */
 int mm_init(void)
 {
+#if MM_TCACHE
+    heap_gen++; // 모든 스레드 캐시 무효화 (옛 힙의 블록을 가리킴)
+#endif
+#if MM_SLAB
+    memset(slab_pages, 0, sizeof(slab_pages)); // 옛 힙의 슬랩 페이지 기록 제거
+#endif
+#if USES_FREE_LINKS && MM_OFFSET_LINKS
+    link_base = mem_heap_lo(); // 가용 리스트 링크 오프셋의 원점
+#endif
+#ifdef MM_THREADS
+    pthread_once(&arena_once, init_arena_locks);
+#  if MM_DECAY
+    pthread_mutex_lock(&decay_lock); // 워커가 옛 힙을 순회 중이면 끝날 때까지 기다림
+#  endif
+    for (int i = 0; i < MM_ARENAS; i++) {
+        arena = &arenas[i];
+        init_free_lists();
+        arena->heap_listp = NULL; // 세그먼트는 처음 확장할 때 arena_sbrk가 만든다
+        arena->top = NULL;
+        arena->remote_free = NULL;
+    }
+
+    // 0번 아레나에 초기 가용 블록 생성 (프롤로그/에필로그는 arena_sbrk가 세그먼트와 함께 생성)
+    ARENA_ENTER(&arenas[0]);
+    void *bp = extend_heap(CHUNKSIZE/WSIZE);
+    ARENA_LEAVE();
+#  if MM_DECAY
+    decay_reset(); // 아레나의 감쇠 기록/반납 비트맵을 비우고, 처음이면 워커 시작
+    pthread_mutex_unlock(&decay_lock);
+#  endif
+    return (bp == NULL) ? -1 : 0;
+#elif ALLOC_POLICY == POLICY_BUDDY
+    // 버디: 프롤로그 대신 원점을 정하고, 첫 블록 자리에 에필로그만 둔다
+    char *lo = mem_heap_lo();
+    arena->buddy_base = (char *)(((uintptr_t)lo + WSIZE) & ~(uintptr_t)(BUDDY_ORIGIN_ALIGN - 1)) - WSIZE; // lo 이하에서 가장 가까운 원점
+    size_t first = ((size_t)(lo - arena->buddy_base) + MIN_BLOCK - 1) & ~(size_t)(MIN_BLOCK - 1); // 최소 차수 경계로 올림
+    arena->buddy_lo = arena->buddy_base + first;
+    if (mem_sbrk((int)(arena->buddy_lo - lo) + WSIZE) == (void *)-1)
+        return -1;
+    PUT(arena->buddy_lo, PACK(0, 1)); /* epilogue header - 에필로그 헤더 (크기:0, 할당됨) */
+    arena->heap_listp = arena->buddy_lo + WSIZE;
+    init_free_lists();
+
+    // 초기 가용 블록 생성을 위해 힙 확장
+    if (extend_heap(CHUNKSIZE/WSIZE) == NULL)
+        return -1;
+    return 0;
+#else
     // 프롤로그와 에필로그를 포함한 최초 힙 생성 (4워드 = 16바이트)
-    if ((heap_listp = mem_sbrk(4*WSIZE)) == (void *)-1)
+    if ((arena->heap_listp = mem_sbrk(4*WSIZE)) == (void *)-1)
         return -1; // 힙 확장 실패시 -1 반환
 
-    PUT(heap_listp, 0);                         /* alignment padding - 정렬을 위한 패딩 */
-    PUT(heap_listp + (1*WSIZE), PACK(DSIZE, 1));/* prologue header - 프롤로그 헤더 (크기:8, 할당됨) */
-    PUT(heap_listp + (2*WSIZE), PACK(DSIZE, 1));/* prologue footer - 프롤로그 푸터 (크기:8, 할당됨) */
-    PUT(heap_listp + (3*WSIZE), PACK(0, 1));    /* epilogue header - 에필로그 헤더 (크기:0, 할당됨) */
-    heap_listp += (2*WSIZE); // 힙 리스트 포인터를 프롤로그 블록의 payload로 이동
+    PUT(arena->heap_listp, 0);                         /* alignment padding - 정렬을 위한 패딩 */
+    PUT(arena->heap_listp + (1*WSIZE), PACK(DSIZE, 1));/* prologue header - 프롤로그 헤더 (크기:8, 할당됨) */
+    PUT(arena->heap_listp + (2*WSIZE), PACK(DSIZE, 1));/* prologue footer - 프롤로그 푸터 (크기:8, 할당됨) */
+    PUT(arena->heap_listp + (3*WSIZE), PACK(0, PREV_ALLOC | 1)); /* epilogue header - 에필로그 헤더 (크기:0, 할당됨, 앞의 프롤로그도 할당됨) */
+    arena->heap_listp += (2*WSIZE); // 힙 리스트 포인터를 프롤로그 블록의 payload로 이동
 
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-    free_listp = NULL; // 명시적 가용 리스트 초기화 - 빈 리스트로 시작
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-    // 분리 가용 리스트 초기화 - 모든 크기 클래스를 빈 리스트로 시작
-    for (int i = 0; i < SEGREGATED_CLASSES; i++) {
-        segregated_lists[i] = NULL;
-    }
-#endif
+    init_free_lists();
 #if ALLOC_POLICY == POLICY_IMPLICIT_NF
-    rover = heap_listp; // next-fit용 rover를 힙 시작점으로 초기화
+    arena->rover = arena->heap_listp; // next-fit용 rover를 힙 시작점으로 초기화
 #endif
 
     // 초기 가용 블록 생성을 위해 힙 확장 (CHUNKSIZE/WSIZE = 1024워드)
     if (extend_heap(CHUNKSIZE/WSIZE) == NULL)
         return -1; // 확장 실패시 -1 반환
     return 0; // 초기화 성공
+#endif
 }
 
 /*
@@ -217,18 +950,68 @@ int mm_init(void)
  */
 static void *extend_heap(size_t words)
 {
+#if ALLOC_POLICY == POLICY_BUDDY
+    // 버디: 원하는 크기의 블록이 정렬된 자리에 붙을 때까지 힙 끝을 그 자리에 맞는 조각으로 채운다
+    size_t want = BUDDY_ROUND(words * WSIZE);
+    for (;;) {
+        char *hdr = BUDDY_END(); // 옛 에필로그 자리
+        size_t off = (size_t)(hdr - arena->buddy_base);
+        size_t size = (off & (want - 1)) ? (off & -off) : want; // 정렬이 안 맞으면 오프셋의 최하위 비트 크기 조각
+        if (arena_sbrk(size) == (void *)-1)
+            return NULL;
+        PUT(hdr, PACK(size, 0));        /* free block header - 새 가용 블록 헤더 */
+        PUT(hdr + size, PACK(0, 1));    /* new epilogue - 새로운 에필로그 헤더 */
+        char *bp = coalesce(hdr + WSIZE); // 버디가 가용이면 병합
+        if (size == want) return bp;
+    }
+#else
     char *bp; // 새로 확장된 블록의 시작주소를 가리키는 포인터
-    size_t size = (words % 2) ? (words+1)*WSIZE : words*WSIZE; /* keep 8-byte alignment - 8바이트 정렬을 위해 홀수면 +1 */
+    size_t size = ALIGN(words * WSIZE); /* keep payload alignment - 블록 크기를 ALIGNMENT의 배수로 올림 */
     
-    if ((bp = mem_sbrk(size)) == (void *)-1) // 힙 확장 요청
+    if ((bp = arena_sbrk(size)) == (void *)-1) // 힙 확장 요청 (현재 아레나)
         return NULL; // 확장 실패시 NULL 반환
 
-    PUT(HDRP(bp), PACK(size, 0));              /* free block header - 새 가용 블록 헤더 설정 */
+    PUT(HDRP(bp), PACK(size, GET_PREV_ALLOC(HDRP(bp)))); /* free block header - 옛 에필로그 자리에 새 가용 블록 헤더 (prev-alloc 비트 유지) */
     PUT(FTRP(bp), PACK(size, 0));              /* free block footer - 새 가용 블록 푸터 설정 */
-    PUT(HDRP(NEXT_BLKP(bp)), PACK(0, 1));      /* new epilogue - 새로운 에필로그 헤더 설정 */
+    PUT(HDRP(NEXT_BLKP(bp)), PACK(0, 1));      /* new epilogue - 새로운 에필로그 헤더 설정 (앞 블록은 가용) */
 
     return coalesce(bp); // 이전 블록이 가용이면 병합 후 반환
+#endif
+}
+
+#if MM_ADAPT_EXTEND
+/*
+ * extend_fit - find_fit이 실패했을 때 asize 이상의 가용 블록을 힙 끝에 마련 (호출자가 아레나 락을 잡고 있음)
+ * 에필로그 앞 블록이 이미 가용이면 모자란 만큼만 늘린다. 최소 확장 단위(extend_chunk)는
+ * 확장 사이의 할당 수로 조절한다: 지난 확장분을 작은 할당 여럿(EXTEND_BURST 이상)이 나눠 썼으면
+ * 두 배로 늘리되 힙 크기의 1/2^EXTEND_HEAP_SHIFT를 넘지 않고, 큰 할당 몇 개가 썼으면 절반으로 줄인다
+ * (큰 요청마다 힙 끝에 넉넉한 가용 블록을 남기면 그 블록이 잘게 쪼개져 단편화가 늘어난다).
+ */
+static void *extend_fit(size_t asize)
+{
+    char *end = heap_end(); // 그 자리에서 늘릴 수 없으면 NULL (새 세그먼트)
+    size_t tsize = (end && !GET_PREV_ALLOC(HDRP(end))) ? GET_SIZE(HDRP(end) - WSIZE) : 0; // 에필로그 앞 가용 블록 (푸터로 크기)
+    if (tsize >= asize) return end - tsize; // good-fit 정책(TLSF)은 힙 끝 블록을 못 찾았을 수 있음
+
+    unsigned long since = arena->nallocs - arena->extend_mark; // 지난 확장 이후 할당 수
+    arena->extend_mark = arena->nallocs;
+    HEAP_LOCK();
+    size_t cap = MAX(CHUNKSIZE, mem_heapsize() >> EXTEND_HEAP_SHIFT);
+    HEAP_UNLOCK();
+    if (since >= EXTEND_BURST)
+        arena->extend_chunk = MIN(2 * arena->extend_chunk, cap);
+    else
+        arena->extend_chunk = MAX(arena->extend_chunk / 2, CHUNKSIZE);
+    arena->extend_chunk = MIN(arena->extend_chunk, cap) & ~(size_t)(ALIGNMENT - 1); // 힙이 trim으로 줄었을 수 있음
+
+    char *bp = extend_heap(MAX(asize - tsize, arena->extend_chunk)/WSIZE); // 맨 끝 가용 블록과 병합됨
+    if (bp != NULL && GET_SIZE(HDRP(bp)) < asize) // 사이에 다른 아레나가 힙을 늘려 새 세그먼트에 생김
+        bp = extend_heap(MAX(asize, arena->extend_chunk)/WSIZE);
+    return bp;
 }
+#else
+#  define extend_fit(asize)  extend_heap(MAX(asize, CHUNKSIZE)/WSIZE) // 요청 크기와 기본 확장 크기 중 큰 값
+#endif
 
 /*************************** Policy: free-list ops ****************************/
 #if ALLOC_POLICY == POLICY_EXPLICIT_FF
@@ -239,10 +1022,10 @@ static void *extend_heap(size_t words)
 static void insert_free_block(void *bp)
 {
     SET_PREV(bp, NULL); // 새로 넣을 노드 bp가 head가 될 것이므로 이전 노드는 NULL
-    SET_NEXT(bp, free_listp); // 새 head의 next는 기존 head(free_listp)를 가리킴
+    SET_NEXT(bp, arena->free_listp); // 새 head의 next는 기존 head(free_listp)를 가리킴
 
-    if (free_listp) SET_PREV(free_listp, bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
-    free_listp = (char *)bp; // 헤드 포인터를 bp로 갱신하여 bp가 새 head가 됨
+    if (arena->free_listp) SET_PREV(arena->free_listp, bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
+    arena->free_listp = (char *)bp; // 헤드 포인터를 bp로 갱신하여 bp가 새 head가 됨
 }
 
 /*
@@ -257,69 +1040,551 @@ static void remove_free_block(void *bp)
     // bp의 이전 블록이 있다면 그것의 next를 bp의 next로 연결
     // 없다면 (bp가 head였다면) free_listp를 bp의 next로 변경 (head 교체)
     if (prev) SET_NEXT(prev, next); 
-    else      free_listp = next;
+    else      arena->free_listp = next;
     
     // bp의 다음 블록이 있다면 그것의 prev를 bp의 prev로 연결
     if (next) SET_PREV(next, prev);
 }
-#endif
 
-/******************* Segregated free list management *******************/
-#if ALLOC_POLICY == POLICY_SEGREGATED_BF
 /*
- * get_size_class - 블록 크기에 해당하는 분리 리스트 클래스 번호 반환
- * 크기에 따라 0~9 클래스로 분류한다.
+ * find_fit - 가용 리스트 first-fit (요청 크기 이상인 첫 블록)
  */
-static int get_size_class(size_t size)
+static void *find_fit(size_t asize)
 {
-    // 이진 로그를 이용한 효율적인 클래스 결정
-    if (size < 32) return 0;        // 16-31B
-    if (size < 64) return 1;        // 32-63B  
-    if (size < 128) return 2;       // 64-127B
-    if (size < 256) return 3;       // 128-255B
-    if (size < 512) return 4;       // 256-511B
-    if (size < 1024) return 5;      // 512-1023B
-    if (size < 2048) return 6;      // 1024-2047B
-    if (size < 4096) return 7;      // 2048-4095B
-    if (size < 8192) return 8;      // 4096-8191B
-    return 9;                       // 8192B+
+    // 명시적 first-fit: 가용 리스트를 처음부터 순회하며 첫 번째 적합한 블록 반환
+    for (char *bp = arena->free_listp; bp != NULL; bp = NEXT_FREEP(bp)) {
+        if (GET_SIZE(HDRP(bp)) >= asize) return bp; // 요청 크기 이상이면 즉시 반환
+    }
+    return NULL; // 적합한 블록 없음
 }
+#endif
+
+/************************ Policy: implicit list (FF / NF) ***********************/
+#if ALLOC_POLICY == POLICY_IMPLICIT_FF
 
 /*
- * insert_segregated_block - 해당 크기 클래스의 분리 리스트에 블록 추가 (LIFO 방식)
- * 크기에 맞는 분리 리스트의 맨 앞에 삽입한다.
+ * find_fit - 힙 first-fit (요청 크기 이상인 첫 가용 블록)
  */
-static void insert_segregated_block(void *bp)
+static void *find_fit(size_t asize)
 {
-    size_t size = GET_SIZE(HDRP(bp));
-    int class = get_size_class(size);
-    
-    SET_PREV(bp, NULL); // 새로 넣을 노드가 head가 될 것이므로 이전 노드는 NULL
-    SET_NEXT(bp, segregated_lists[class]); // 새 head의 next는 기존 head를 가리킴
-
-    if (segregated_lists[class]) SET_PREV(segregated_lists[class], bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
-    segregated_lists[class] = (char *)bp; // 헤드 포인터를 bp로 갱신하여 bp가 새 head가 됨
+    // 암시적 first-fit: 힙 시작부터 순회하며 첫 번째 적합한 블록 반환
+    for (char *bp = arena->heap_listp; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+        // 가용블록이고 요청 크기 이상이면 적합
+        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) return bp;
+    }
+    return NULL; // 적합한 블록 없음
 }
+#elif ALLOC_POLICY == POLICY_IMPLICIT_NF
 
 /*
- * remove_segregated_block - 해당 크기 클래스의 분리 리스트에서 블록 제거
- * 지정된 블록을 분리 리스트에서 제거하고 앞뒤 연결을 수정한다.
+ * find_fit - 힙 next-fit (rover부터 순환 탐색)
  */
-static void remove_segregated_block(void *bp)
+static void *find_fit(size_t asize)
 {
-    size_t size = GET_SIZE(HDRP(bp));
-    int class = get_size_class(size);
-    
-    char *prev = PREV_FREEP(bp); // 제거할 블록의 이전 블록 주소
+    // 암시적 next-fit: rover 위치부터 힙 끝까지 탐색
+    char *bp;
+    // 첫 번째 탐색: rover에서 힙 끝까지
+    for (bp = arena->rover; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+        // 가용블록이고 요청 크기 이상이면 적합
+        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) {
+            arena->rover = bp; // 찾은 위치를 rover에 기록하여 다음 탐색 시작점으로 설정
+            return bp;
+        }
+    }
+    // 두 번째 탐색: 힙 시작에서 rover 이전까지 (순환 탐색)
+    for (bp = arena->heap_listp; bp < arena->rover; bp = NEXT_BLKP(bp)) {
+        // 가용블록이고 요청 크기 이상이면 적합
+        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) {
+            arena->rover = bp; // 찾은 위치를 rover에 기록하여 다음 탐색 시작점으로 설정
+            return bp;
+        }
+    }
+    return NULL; // 적합한 블록 없음
+}
+#endif
+
+/*************************** AA tree (TREE_BF / ADDRESS_FF) ***************************/
+#if USES_AA_TREE
+#  if ALLOC_POLICY == POLICY_TREE_BF
+/*
+ * tree_less - 트리 키 비교: 크기가 작을수록, 같으면 주소가 낮을수록 앞선다.
+ * 트리 안에 있는 동안 블록 헤더의 size는 바뀌지 않는다 (병합/분할 전에 항상 먼저 제거).
+ */
+static inline int tree_less(char *a, char *b)
+{
+    size_t sa = GET_SIZE(HDRP(a)), sb = GET_SIZE(HDRP(b));
+    return sa < sb || (sa == sb && a < b);
+}
+
+#    define tree_fix(t)        ((void)(t)) // 크기순 트리는 덧붙인 값이 없음
+#  else
+/* tree_less - 트리 키 비교: 주소가 낮을수록 앞선다 */
+static inline int tree_less(char *a, char *b)
+{
+    return a < b;
+}
+
+/*
+ * tree_fix - 자식이 바뀐 노드 t의 서브트리 최대 크기를 다시 계산
+ * (트리 안에 있는 동안 블록 크기는 바뀌지 않으므로 자식의 값만 보면 된다)
+ */
+static inline void tree_fix(char *t)
+{
+    uint32_t max = GET_SIZE(HDRP(t));
+    if (TREE_LEFT(t) && TREE_MAX(TREE_LEFT(t)) > max) max = TREE_MAX(TREE_LEFT(t));
+    if (TREE_RIGHT(t) && TREE_MAX(TREE_RIGHT(t)) > max) max = TREE_MAX(TREE_RIGHT(t));
+    TREE_MAX(t) = max;
+}
+#  endif
+
+/* tree_level - 노드 레벨 (NULL은 0) */
+static inline unsigned tree_level(char *t)
+{
+    return t ? TREE_LEVEL(t) : 0;
+}
+
+/*
+ * tree_skew - 왼쪽 수평 링크 제거 (오른쪽 회전)
+ * 왼쪽 자식이 같은 레벨이면 회전하여 수평 링크를 오른쪽으로 돌린다.
+ */
+static char *tree_skew(char *t)
+{
+    char *l;
+    if (t && (l = TREE_LEFT(t)) && TREE_LEVEL(l) == TREE_LEVEL(t)) {
+        TREE_LEFT(t) = TREE_RIGHT(l);
+        TREE_RIGHT(l) = t;
+        tree_fix(t); // 아래로 내려간 t부터
+        tree_fix(l);
+        return l;
+    }
+    return t;
+}
+
+/*
+ * tree_split - 연속된 오른쪽 수평 링크 두 개 제거 (왼쪽 회전 + 레벨 승격)
+ */
+static char *tree_split(char *t)
+{
+    char *r;
+    if (t && (r = TREE_RIGHT(t)) && TREE_RIGHT(r) && TREE_LEVEL(TREE_RIGHT(r)) == TREE_LEVEL(t)) {
+        TREE_RIGHT(t) = TREE_LEFT(r);
+        TREE_LEFT(r) = t;
+        TREE_LEVEL(r)++;
+        tree_fix(t);
+        tree_fix(r);
+        return r;
+    }
+    return t;
+}
+
+/*
+ * tree_insert - 서브트리 t에 블록 bp를 삽입하고 새 서브트리 루트 반환
+ * 내려가며 위치를 찾고, 올라오며 skew/split으로 균형을 맞춘다.
+ */
+static char *tree_insert(char *t, char *bp)
+{
+    if (t == NULL) { // 빈 자리에 리프로 매달기
+        TREE_LEFT(bp) = NULL;
+        TREE_RIGHT(bp) = NULL;
+        TREE_LEVEL(bp) = 1;
+        tree_fix(bp);
+        return bp;
+    }
+    if (tree_less(bp, t)) TREE_LEFT(t) = tree_insert(TREE_LEFT(t), bp);
+    else                  TREE_RIGHT(t) = tree_insert(TREE_RIGHT(t), bp);
+    tree_fix(t); // 회전이 없어도 자식 서브트리가 바뀌었음
+    return tree_split(tree_skew(t));
+}
+
+/*
+ * tree_delete - 서브트리 t에서 블록 bp를 제거하고 새 서브트리 루트 반환
+ * 노드가 곧 블록이라 키를 복사할 수 없으므로, 자식이 둘인 노드는
+ * 오른쪽 서브트리의 최소 노드(후계자)를 떼어내 그 자리에 링크째로 옮긴다.
+ */
+static char *tree_delete(char *t, char *bp)
+{
+    if (t == NULL) return NULL; // 트리에 없음 (발생하지 않음)
+
+    if (t == bp) {
+        if (TREE_LEFT(t) == NULL) return TREE_RIGHT(t);  // 레벨 1 노드: 오른쪽 자식(있다면)이 대신함
+        if (TREE_RIGHT(t) == NULL) return TREE_LEFT(t);  // AA 트리에서는 발생하지 않지만 방어
+        char *succ = TREE_RIGHT(t);
+        while (TREE_LEFT(succ)) succ = TREE_LEFT(succ);  // 후계자 = 오른쪽 서브트리의 최소 노드
+        TREE_RIGHT(t) = tree_delete(TREE_RIGHT(t), succ); // 후계자를 먼저 떼어냄
+        TREE_LEFT(succ) = TREE_LEFT(t);                  // 후계자가 t의 자리를 차지
+        TREE_RIGHT(succ) = TREE_RIGHT(t);
+        TREE_LEVEL(succ) = TREE_LEVEL(t);
+        t = succ;
+    } else if (tree_less(bp, t)) {
+        TREE_LEFT(t) = tree_delete(TREE_LEFT(t), bp);
+    } else {
+        TREE_RIGHT(t) = tree_delete(TREE_RIGHT(t), bp);
+    }
+    tree_fix(t); // 자식이 바뀌었거나 후계자가 자리를 옮겨 옴
+
+    // 자식 레벨에 맞춰 레벨을 낮추고 다시 균형 맞추기
+    unsigned want = MIN(tree_level(TREE_LEFT(t)), tree_level(TREE_RIGHT(t))) + 1;
+    if (want < TREE_LEVEL(t)) {
+        TREE_LEVEL(t) = want;
+        if (TREE_RIGHT(t) && want < TREE_LEVEL(TREE_RIGHT(t))) TREE_LEVEL(TREE_RIGHT(t)) = want;
+    }
+    t = tree_skew(t);
+    TREE_RIGHT(t) = tree_skew(TREE_RIGHT(t));
+    if (TREE_RIGHT(t)) TREE_RIGHT(TREE_RIGHT(t)) = tree_skew(TREE_RIGHT(TREE_RIGHT(t)));
+    t = tree_split(t);
+    TREE_RIGHT(t) = tree_split(TREE_RIGHT(t));
+    return t;
+}
+
+#  if ALLOC_POLICY == POLICY_TREE_BF
+/*
+ * tree_best_fit - asize 이상인 블록 중 키가 가장 작은 블록 (정확한 best-fit, 동률은 낮은 주소)
+ */
+static char *tree_best_fit(size_t asize)
+{
+    char *best = NULL;
+    for (char *t = arena->tree_root; t != NULL; ) {
+        if (GET_SIZE(HDRP(t)) >= asize) { best = t; t = TREE_LEFT(t); } // 후보 기록 후 더 작은 쪽 탐색
+        else                            t = TREE_RIGHT(t);
+    }
+    return best;
+}
+#  else
+/*
+ * insert_address_block / remove_address_block - 가용 블록을 주소순 트리에 넣고 뺌 (O(log n))
+ */
+static void insert_address_block(void *bp)
+{
+    arena->tree_root = tree_insert(arena->tree_root, bp);
+}
+
+static void remove_address_block(void *bp)
+{
+    arena->tree_root = tree_delete(arena->tree_root, bp);
+}
+
+/*
+ * find_fit - 주소순 first-fit: asize 이상인 블록 중 주소가 가장 낮은 블록
+ * 왼쪽(낮은 주소) 서브트리의 최대 크기가 asize 이상이면 왼쪽으로, 아니면 자신, 그것도 아니면 오른쪽으로.
+ */
+static void *find_fit(size_t asize)
+{
+    char *t = arena->tree_root;
+    if (t == NULL || TREE_MAX(t) < asize) return NULL; // 트리 전체에 맞는 블록이 없음
+
+    for (;;) {
+        char *l = TREE_LEFT(t);
+        if (l && TREE_MAX(l) >= asize) t = l;          // 더 낮은 주소에 맞는 블록이 있음
+        else if (GET_SIZE(HDRP(t)) >= asize) return t; // 왼쪽에는 없고 t가 맞음
+        else t = TREE_RIGHT(t);                        // 맞는 블록은 오른쪽에만 있음
+    }
+}
+#  endif
+#endif
+
+/******************* Segregated free list management *******************/
+#if USES_SEGREGATED_LISTS
+/*
+ * get_size_class - 블록 크기에 해당하는 분리 리스트 클래스 번호 반환
+ * count-leading-zeros로 floor(log2(size))를 구해 구간을 정하고,
+ * 그 아래 SEG_SUB_LOG2 비트로 구간 안의 하위 클래스를 정한다. 분기 없는 O(1) 계산.
+ */
+static inline int get_size_class(size_t size)
+{
+    int fl = 63 - __builtin_clzll((unsigned long long)size); // floor(log2(size))
+    int band = fl - SEG_MIN_LOG2; // 16-31B가 0번 구간
+
+    if (band < 0) return 0;                                   // 16B 미만 (발생하지 않지만 방어)
+    if (band >= SEG_BANDS) return SEGREGATED_CLASSES - 1;     // 마지막 클래스는 그 이상 전부
+    // 최상위 비트 바로 아래 SEG_SUB_LOG2 비트가 구간 안의 선형 하위 클래스
+    int sub = (int)(size >> (fl - SEG_SUB_LOG2)) & ((1 << SEG_SUB_LOG2) - 1);
+    return (band << SEG_SUB_LOG2) | sub;
+}
+
+/*
+ * seg_next_nonempty - from 이상인 클래스 중 비어있지 않은 첫 클래스 번호 반환 (없으면 -1)
+ * 비트맵 워드마다 find-first-set 한 번으로 찾는다 (128클래스여도 최대 2워드).
+ */
+static inline int seg_next_nonempty(int from)
+{
+    if (from >= SEGREGATED_CLASSES) return -1;
+    int w = from >> 6; // from이 속한 비트맵 워드
+    uint64_t bits = arena->seg_bitmap[w] & (~0ULL << (from & 63)); // from 미만 클래스는 가림
+
+    while (bits == 0) { // 이 워드에 후보가 없으면 다음 워드로
+        if (++w >= SEG_BITMAP_WORDS) return -1;
+        bits = arena->seg_bitmap[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+}
+
+/*
+ * insert_segregated_block - 해당 크기 클래스의 분리 리스트에 블록 추가 (LIFO 방식)
+ * 크기에 맞는 분리 리스트의 맨 앞에 삽입한다.
+ */
+static void insert_segregated_block(void *bp)
+{
+    size_t size = GET_SIZE(HDRP(bp));
+#if ALLOC_POLICY == POLICY_TREE_BF
+    if (size >= TREE_MIN_SIZE) { arena->tree_root = tree_insert(arena->tree_root, bp); return; } // 큰 블록은 크기순 트리로
+#endif
+    int class = get_size_class(size);
+    
+    SET_PREV(bp, NULL); // 새로 넣을 노드가 head가 될 것이므로 이전 노드는 NULL
+    SET_NEXT(bp, arena->segregated_lists[class]); // 새 head의 next는 기존 head를 가리킴
+
+    if (arena->segregated_lists[class]) SET_PREV(arena->segregated_lists[class], bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
+    arena->segregated_lists[class] = (char *)bp; // 헤드 포인터를 bp로 갱신하여 bp가 새 head가 됨
+    arena->seg_bitmap[class >> 6] |= 1ULL << (class & 63); // 클래스가 비어있지 않음을 표시
+}
+
+/*
+ * remove_segregated_block - 해당 크기 클래스의 분리 리스트에서 블록 제거
+ * 지정된 블록을 분리 리스트에서 제거하고 앞뒤 연결을 수정한다.
+ */
+static void remove_segregated_block(void *bp)
+{
+    size_t size = GET_SIZE(HDRP(bp));
+#if ALLOC_POLICY == POLICY_TREE_BF
+    if (size >= TREE_MIN_SIZE) { arena->tree_root = tree_delete(arena->tree_root, bp); return; } // 큰 블록은 트리에서 제거
+#endif
+    int class = get_size_class(size);
+    
+    char *prev = PREV_FREEP(bp); // 제거할 블록의 이전 블록 주소
     char *next = NEXT_FREEP(bp); // 제거할 블록의 다음 블록 주소
 
     // bp의 이전 블록이 있다면 그것의 next를 bp의 next로 연결
     // 없다면 (bp가 head였다면) 해당 클래스의 head를 bp의 next로 변경
     if (prev) SET_NEXT(prev, next); 
-    else      segregated_lists[class] = next;
+    else      arena->segregated_lists[class] = next;
     
     // bp의 다음 블록이 있다면 그것의 prev를 bp의 prev로 연결
     if (next) SET_PREV(next, prev);
+
+    // 리스트가 비었으면 비트맵에서 클래스 비트 제거
+    if (arena->segregated_lists[class] == NULL) arena->seg_bitmap[class >> 6] &= ~(1ULL << (class & 63));
+}
+
+/*
+ * find_fit - 분리 가용 리스트 best-fit (TREE_BF는 큰 요청을 트리에서)
+ */
+static void *find_fit(size_t asize)
+{
+    // 분리 가용 리스트 + best-fit: 해당 크기 클래스부터 시작해서 best-fit 탐색
+#if ALLOC_POLICY == POLICY_TREE_BF
+    if (asize >= TREE_MIN_SIZE) return tree_best_fit(asize); // 큰 요청은 트리에서 바로 O(log n) best-fit
+#endif
+    // 시작 클래스에는 asize보다 작은 블록도 섞여 있으므로 리스트를 순회해야 하지만,
+    // 그 위 클래스는 비트맵으로 비어있지 않은 첫 클래스를 바로 찾는다 (빈 클래스 순회 없음).
+    for (int class = get_size_class(asize); class >= 0; class = seg_next_nonempty(class + 1)) {
+        void *best_bp = NULL;
+        size_t best_size = SIZE_MAX;
+
+        // 해당 클래스의 리스트를 순회하며 best-fit 찾기
+        for (char *bp = arena->segregated_lists[class]; bp != NULL; bp = NEXT_FREEP(bp)) {
+            size_t block_size = GET_SIZE(HDRP(bp));
+            if (block_size >= asize && block_size < best_size) {
+                // 현재까지 찾은 best보다 더 적합한(작은) 블록이면 업데이트
+                best_bp = bp;
+                best_size = block_size;
+                // 정확히 맞는 크기를 찾았으면 즉시 반환 (perfect fit)
+                if (best_size == asize) return best_bp;
+            }
+        }
+        // 해당 클래스에서 적합한 블록을 찾았으면 반환 (하위 클래스에서 찾는 것이 더 효율적)
+        if (best_bp) return best_bp;
+    }
+#if ALLOC_POLICY == POLICY_TREE_BF
+    return tree_best_fit(asize); // 리스트에 없으면 트리의 가장 작은 블록 (모두 asize 이상)
+#else
+    return NULL; // 적합한 블록 없음
+#endif
+}
+#endif
+
+/************************* TLSF free list management **************************/
+#if ALLOC_POLICY == POLICY_TLSF
+/*
+ * tlsf_mapping_insert - 블록 크기가 속하는 (fl, sl) 리스트 계산 (내림)
+ * 삽입/제거할 때 사용한다. 블록은 자기 크기 이하의 가장 큰 경계를 가진 리스트에 들어간다.
+ */
+static inline void tlsf_mapping_insert(size_t size, int *fl, int *sl)
+{
+    int msb = 63 - __builtin_clzll((unsigned long long)size); // floor(log2(size))
+    *sl = (int)(size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT; // 최상위 비트를 떼어낸 다음 SL 비트
+    *fl = msb - TLSF_FL_SHIFT;
+}
+
+/*
+ * tlsf_mapping_search - 요청 크기를 만족하는 첫 (fl, sl) 리스트 계산 (올림)
+ * 크기를 다음 2단계 경계로 올려서 매핑하므로, 찾은 리스트의 어떤 블록이든 요청 크기 이상이다.
+ */
+static inline void tlsf_mapping_search(size_t size, int *fl, int *sl)
+{
+    int msb = 63 - __builtin_clzll((unsigned long long)size);
+    size += ((size_t)1 << (msb - TLSF_SL_LOG2)) - 1; // 다음 2단계 경계로 올림
+    tlsf_mapping_insert(size, fl, sl);
+}
+
+/*
+ * insert_tlsf_block - (fl, sl) 리스트의 맨 앞에 블록 추가 (LIFO 방식) 후 두 비트맵 갱신
+ */
+static void insert_tlsf_block(void *bp)
+{
+    int fl, sl;
+    tlsf_mapping_insert(GET_SIZE(HDRP(bp)), &fl, &sl);
+
+    char *head = arena->tlsf_lists[fl][sl];
+    SET_PREV(bp, NULL); // 새로 넣을 노드가 head가 될 것이므로 이전 노드는 NULL
+    SET_NEXT(bp, head); // 새 head의 next는 기존 head를 가리킴
+    if (head) SET_PREV(head, bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
+    arena->tlsf_lists[fl][sl] = (char *)bp;
+
+    arena->tlsf_fl_bitmap |= 1U << fl;     // 1단계 구간이 비어있지 않음
+    arena->tlsf_sl_bitmap[fl] |= 1U << sl; // 2단계 리스트가 비어있지 않음
+}
+
+/*
+ * remove_tlsf_block - (fl, sl) 리스트에서 블록 제거, 리스트가 비면 비트맵 비트도 제거
+ */
+static void remove_tlsf_block(void *bp)
+{
+    int fl, sl;
+    tlsf_mapping_insert(GET_SIZE(HDRP(bp)), &fl, &sl);
+
+    char *prev = PREV_FREEP(bp); // 제거할 블록의 이전 블록 주소
+    char *next = NEXT_FREEP(bp); // 제거할 블록의 다음 블록 주소
+    if (prev) SET_NEXT(prev, next);
+    else      arena->tlsf_lists[fl][sl] = next; // bp가 head였다면 head 교체
+    if (next) SET_PREV(next, prev);
+
+    if (arena->tlsf_lists[fl][sl] == NULL) { // 리스트가 비었으면 2단계 비트 제거
+        arena->tlsf_sl_bitmap[fl] &= ~(1U << sl);
+        if (arena->tlsf_sl_bitmap[fl] == 0) arena->tlsf_fl_bitmap &= ~(1U << fl); // 구간 전체가 비었으면 1단계 비트도 제거
+    }
+}
+
+/*
+ * find_fit - TLSF good-fit (비트맵 두 번으로 O(1))
+ */
+static void *find_fit(size_t asize)
+{
+    // TLSF good-fit: 리스트 순회 없이 비트맵 find-first-set만으로 블록 결정 (최악 O(1))
+    int fl, sl;
+
+    // 요청 크기가 속한 리스트의 head가 마침 충분히 크면 그대로 사용 (상수 시간 검사로 적합도 향상)
+    tlsf_mapping_insert(asize, &fl, &sl);
+    char *head = arena->tlsf_lists[fl][sl];
+    if (head && GET_SIZE(HDRP(head)) >= asize) return head;
+
+    // 다음 2단계 경계로 올림한 리스트부터는 어떤 블록이든 요청 크기 이상
+    tlsf_mapping_search(asize, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) return NULL; // 표현 가능한 범위 밖
+    uint32_t sl_map = arena->tlsf_sl_bitmap[fl] & (~0U << sl); // 같은 구간에서 sl 이상인 리스트
+    if (sl_map == 0) {
+        // 같은 구간에 없으면 더 큰 1단계 구간 중 비어있지 않은 첫 구간
+        uint32_t fl_map = (fl + 1 < 32) ? (arena->tlsf_fl_bitmap & (~0U << (fl + 1))) : 0;
+        if (fl_map == 0) return NULL; // 적합한 블록 없음
+        fl = __builtin_ctz(fl_map);
+        sl_map = arena->tlsf_sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return arena->tlsf_lists[fl][sl]; // 해당 리스트의 head 반환
+}
+#endif
+
+/************************* Buddy free list management **************************/
+#if ALLOC_POLICY == POLICY_BUDDY
+/*
+ * insert_buddy_block - 블록 차수의 리스트 맨 앞에 추가 (LIFO 방식) 후 비트맵 갱신
+ */
+static void insert_buddy_block(void *bp)
+{
+    int k = BUDDY_ORDER(GET_SIZE(HDRP(bp)));
+    char *head = arena->buddy_lists[k];
+    SET_PREV(bp, NULL); // 새로 넣을 노드가 head가 될 것이므로 이전 노드는 NULL
+    SET_NEXT(bp, head); // 새 head의 next는 기존 head를 가리킴
+    if (head) SET_PREV(head, bp); // 기존 head가 있다면 그것의 prev를 bp로 설정
+    arena->buddy_lists[k] = (char *)bp;
+    arena->buddy_bitmap |= 1U << k; // 차수 k 리스트가 비어있지 않음
+}
+
+/*
+ * remove_buddy_block - 차수 리스트에서 블록 제거, 리스트가 비면 비트맵 비트도 제거
+ */
+static void remove_buddy_block(void *bp)
+{
+    int k = BUDDY_ORDER(GET_SIZE(HDRP(bp)));
+    char *prev = PREV_FREEP(bp); // 제거할 블록의 이전 블록 주소
+    char *next = NEXT_FREEP(bp); // 제거할 블록의 다음 블록 주소
+    if (prev) SET_NEXT(prev, next);
+    else      arena->buddy_lists[k] = next; // bp가 head였다면 head 교체
+    if (next) SET_PREV(next, prev);
+    if (arena->buddy_lists[k] == NULL) arena->buddy_bitmap &= ~(1U << k);
+}
+
+/*
+ * find_fit - 요청 차수 이상에서 가장 작은 차수의 블록
+ */
+static void *find_fit(size_t asize)
+{
+    // 버디: 요청 차수 이상에서 비어있지 않은 가장 작은 차수 리스트의 첫 블록 (비트맵 한 번)
+    uint32_t map = arena->buddy_bitmap & (~0U << BUDDY_ORDER(asize));
+    return map ? arena->buddy_lists[__builtin_ctz(map)] : NULL;
+}
+
+/*
+ * buddy_coalesce - 버디가 같은 차수의 가용 블록인 동안 계속 병합한 뒤 리스트에 넣음
+ * 버디 위치는 원점 기준 오프셋 XOR 블록 크기로 바로 계산되므로 푸터나 이웃 순회가 필요 없다.
+ */
+static void *buddy_coalesce(void *bp)
+{
+    char *hdr = HDRP(bp);
+    size_t size = GET_SIZE(hdr);
+    char *end = BUDDY_END();
+
+    for (;;) {
+        char *bhdr = arena->buddy_base + ((size_t)(hdr - arena->buddy_base) ^ size); // 버디의 헤더
+        if (bhdr < arena->buddy_lo || bhdr + size > end) break; // 버디가 힙 밖 (첫 블록 앞이거나 아직 늘리지 않은 곳)
+        if (GET_ALLOC(bhdr) || GET_SIZE(bhdr) != size) break;  // 버디가 할당됐거나 더 잘게 나뉘어 있음
+        remove_buddy_block(bhdr + WSIZE);
+        if (bhdr < hdr) hdr = bhdr; // 병합된 블록은 둘 중 낮은 주소에서 시작
+        size <<= 1;
+    }
+    PUT(hdr, PACK(size, 0));
+    insert_buddy_block(hdr + WSIZE);
+    return hdr + WSIZE;
+}
+
+/*
+ * buddy_resize - 할당 블록을 제자리에서 asize(2의 거듭제곱)로 바꿈 (성공하면 1)
+ * 줄일 때는 위쪽 절반들을 가용으로 돌려보내고, 늘릴 때는 블록이 매 단계 아래쪽 절반이고
+ * 위쪽 버디가 통째로 가용일 때만 흡수한다.
+ */
+static int buddy_resize(void *bp, size_t asize)
+{
+    char *hdr = HDRP(bp);
+    size_t size = GET_SIZE(hdr);
+
+    if (asize <= size) { // 축소: 위쪽 절반의 버디는 이 블록(할당됨)이라 병합할 필요가 없음
+        while (size > asize) {
+            size >>= 1;
+            PUT(hdr + size, PACK(size, 0));
+            insert_buddy_block(hdr + size + WSIZE);
+        }
+        PUT(hdr, PACK(size, 1));
+        return 1;
+    }
+
+    char *end = BUDDY_END();
+    for (size_t s = size; s < asize; s <<= 1) { // 확장 가능 여부를 먼저 모두 확인
+        if ((size_t)(hdr - arena->buddy_base) & s) return 0; // 이 단계에서 위쪽 절반이면 버디가 앞에 있음
+        if (hdr + 2*s > end || GET_ALLOC(hdr + s) || GET_SIZE(hdr + s) != s) return 0;
+    }
+    for (size_t s = size; s < asize; s <<= 1)
+        remove_buddy_block(hdr + s + WSIZE);
+    PUT(hdr, PACK(asize, 1));
+    return 1;
 }
 #endif
 
@@ -330,252 +1595,940 @@ static void remove_segregated_block(void *bp)
  */
 static void *coalesce(void *bp)
 {
-    // 이전 블록의 할당 상태 확인 - 이전 블록의 푸터에서 alloc 비트 읽기
-    unsigned prev_alloc = GET_ALLOC(FTRP(PREV_BLKP(bp)));
+#if ALLOC_POLICY == POLICY_BUDDY
+    return buddy_coalesce(bp); // 버디: 이웃 대신 주소로 계산한 버디와만 병합
+#else
+    // 이전 블록의 할당 상태 확인 - 현재 블록 헤더의 prev-alloc 비트 (이전 블록 푸터는 가용일 때만 읽음)
+    unsigned prev_alloc = GET_PREV_ALLOC(HDRP(bp));
     // 다음 블록의 할당 상태 확인 - 다음 블록의 헤더에서 alloc 비트 읽기
     unsigned next_alloc = GET_ALLOC(HDRP(NEXT_BLKP(bp)));
     // 현재 블록의 크기 - 헤더에서 size 필드 추출
     size_t size = GET_SIZE(HDRP(bp));
 
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-    if (prev_alloc && next_alloc) { // Case 1: 이전과 다음 블록이 모두 할당됨 - 병합 불가
-        insert_free_block(bp); // 현재 블록만 가용 리스트에 추가
-        return bp;
-    } else if (prev_alloc && !next_alloc) { // Case 2: 이전 블록은 할당, 다음 블록은 가용 - 다음과 병합
-        void *next = NEXT_BLKP(bp); // 다음 블록 포인터
-        remove_free_block(next); // 다음 블록을 가용 리스트에서 제거
-        size += GET_SIZE(HDRP(next)); // 현재 블록 크기에 다음 블록 크기 추가
-        PUT(HDRP(bp), PACK(size, 0)); // 병합된 블록의 헤더 설정 (현재 위치)
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 위치)
-        insert_free_block(bp); // 병합된 블록을 가용 리스트에 추가
-        return bp;
-    } else if (!prev_alloc && next_alloc) { // Case 3: 이전 블록은 가용, 다음 블록은 할당 - 이전과 병합
-        void *prev = PREV_BLKP(bp); // 이전 블록 포인터
-        remove_free_block(prev); // 이전 블록을 가용 리스트에서 제거
-        size += GET_SIZE(HDRP(prev)); // 현재 블록 크기에 이전 블록 크기 추가
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (현재 위치)
-        PUT(HDRP(prev), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-        insert_free_block(prev); // 병합된 블록을 가용 리스트에 추가
-        return prev;
-    } else { // Case 4: 이전과 다음 블록이 모두 가용 - 삼중 병합
-        void *prev = PREV_BLKP(bp); // 이전 블록 포인터
-        void *next = NEXT_BLKP(bp); // 다음 블록 포인터
-        remove_free_block(prev); // 이전 블록을 가용 리스트에서 제거
-        remove_free_block(next); // 다음 블록을 가용 리스트에서 제거
-        size += GET_SIZE(HDRP(prev)) + GET_SIZE(HDRP(next)); // 세 블록의 크기 모두 합산
-        PUT(HDRP(prev), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-        PUT(FTRP(next), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 위치)
-        insert_free_block(prev); // 병합된 블록을 가용 리스트에 추가
-        return prev;
-    }
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-    if (prev_alloc && next_alloc) { // Case 1: 이전과 다음 블록이 모두 할당됨 - 병합 불가
-        insert_segregated_block(bp); // 현재 블록만 해당 크기 클래스 리스트에 추가
-        return bp;
-    } else if (prev_alloc && !next_alloc) { // Case 2: 이전 블록은 할당, 다음 블록은 가용 - 다음과 병합
+    // 병합 결과 블록의 앞은 항상 할당 블록이므로 (가용 블록은 연속하지 않음) 헤더에 PREV_ALLOC을 둔다.
+    // 다음 블록의 prev-alloc 비트는 bp를 가용으로 만든 호출자가 이미 지웠다.
+    // 4가지 경우 (앞뒤 모두 할당 / 뒤만 가용 / 앞만 가용 / 앞뒤 모두 가용)는
+    // 가용인 이웃을 자료구조에서 빼고 크기를 더하는 두 단계로 모두 처리된다.
+    if (!next_alloc) { // 다음 블록과 병합
         void *next = NEXT_BLKP(bp); // 다음 블록 포인터
-        remove_segregated_block(next); // 다음 블록을 해당 크기 클래스 리스트에서 제거
+        FREE_REMOVE(next); // 다음 블록을 가용 자료구조에서 제거
         size += GET_SIZE(HDRP(next)); // 현재 블록 크기에 다음 블록 크기 추가
-        PUT(HDRP(bp), PACK(size, 0)); // 병합된 블록의 헤더 설정 (현재 위치)
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 위치)
-        insert_segregated_block(bp); // 병합된 블록을 새로운 크기에 맞는 클래스 리스트에 추가
-        return bp;
-    } else if (!prev_alloc && next_alloc) { // Case 3: 이전 블록은 가용, 다음 블록은 할당 - 이전과 병합
-        void *prev = PREV_BLKP(bp); // 이전 블록 포인터
-        remove_segregated_block(prev); // 이전 블록을 해당 크기 클래스 리스트에서 제거
-        size += GET_SIZE(HDRP(prev)); // 현재 블록 크기에 이전 블록 크기 추가
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (현재 위치)
-        PUT(HDRP(prev), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-        insert_segregated_block(prev); // 병합된 블록을 새로운 크기에 맞는 클래스 리스트에 추가
-        return prev; // 병합 후 시작점은 이전 블록
-    } else { // Case 4: 이전과 다음 블록이 모두 가용 - 삼중 병합
-        void *prev = PREV_BLKP(bp); // 이전 블록 포인터
-        void *next = NEXT_BLKP(bp); // 다음 블록 포인터
-        remove_segregated_block(prev); // 이전 블록을 해당 크기 클래스 리스트에서 제거
-        remove_segregated_block(next); // 다음 블록을 해당 크기 클래스 리스트에서 제거
-        size += GET_SIZE(HDRP(prev)) + GET_SIZE(HDRP(next)); // 세 블록의 크기 모두 합산
-        PUT(HDRP(prev), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-        PUT(FTRP(next), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 위치)
-        insert_segregated_block(prev); // 병합된 블록을 새로운 크기에 맞는 클래스 리스트에 추가
-        return prev; // 병합 후 시작점은 이전 블록
-    }
-#else /* IMPLICIT (FF or NF) - 암시적 가용 리스트의 경우 */
-    if (prev_alloc && next_alloc) { // Case 1: 이전과 다음 블록이 모두 할당됨 - 병합 불가
-        return bp; // 현재 블록 그대로 반환
-    } else if (prev_alloc && !next_alloc) { // Case 2: 이전 블록은 할당, 다음 블록은 가용 - 다음과 병합
-        size += GET_SIZE(HDRP(NEXT_BLKP(bp))); // 현재 블록 크기에 다음 블록 크기 추가
-        PUT(HDRP(bp), PACK(size, 0)); // 병합된 블록의 헤더 설정 (현재 위치)
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 끝)
-#if ALLOC_POLICY == POLICY_IMPLICIT_NF
-        // next-fit: rover가 병합되는 영역에 있었다면 새 블록 시작점으로 이동
-        if ((char *)rover >= bp && (char *)rover <= NEXT_BLKP(bp)) {
-            rover = bp;
-        }
-#endif
-        return bp;
-    } else if (!prev_alloc && next_alloc) { // Case 3: 이전 블록은 가용, 다음 블록은 할당 - 이전과 병합
-        size += GET_SIZE(HDRP(PREV_BLKP(bp))); // 현재 블록 크기에 이전 블록 크기 추가
-        PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정 (현재 위치)
-        PUT(HDRP(PREV_BLKP(bp)), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-#if ALLOC_POLICY == POLICY_IMPLICIT_NF
-        // next-fit: rover가 병합되는 영역에 있었다면 새 블록 시작점으로 이동
-        if ((char *)rover >= (char *)PREV_BLKP(bp) && (char *)rover <= (char *)bp) {
-            rover = PREV_BLKP(bp);
-        }
-#endif
-        return PREV_BLKP(bp); // 병합 후 시작점은 이전 블록
-    } else { // Case 4: 이전과 다음 블록이 모두 가용 - 삼중 병합
-        size += GET_SIZE(HDRP(PREV_BLKP(bp))) + GET_SIZE(HDRP(NEXT_BLKP(bp))); // 세 블록의 크기 모두 합산
-        PUT(HDRP(PREV_BLKP(bp)), PACK(size, 0)); // 병합된 블록의 헤더 설정 (이전 블록 위치)
-        PUT(FTRP(NEXT_BLKP(bp)), PACK(size, 0)); // 병합된 블록의 푸터 설정 (다음 블록 위치)
-#if ALLOC_POLICY == POLICY_IMPLICIT_NF
-        // next-fit: rover가 병합되는 영역에 있었다면 새 블록 시작점으로 이동
-        if ((char *)rover >= (char *)PREV_BLKP(bp) && (char *)rover <= (char *)NEXT_BLKP(bp)) {
-            rover = PREV_BLKP(bp);
-        }
-#endif
-        return PREV_BLKP(bp); // 병합 후 시작점은 이전 블록
     }
+    if (!prev_alloc) { // 이전 블록과 병합 - 병합 후 시작점은 이전 블록
+        bp = PREV_BLKP(bp); // 이전 블록 포인터 (이전 블록은 가용이라 푸터가 있음)
+        FREE_REMOVE(bp); // 이전 블록을 가용 자료구조에서 제거
+        size += GET_SIZE(HDRP(bp)); // 현재 블록 크기에 이전 블록 크기 추가
+    }
+    PUT(HDRP(bp), PACK(size, PREV_ALLOC)); // 병합된 블록의 헤더 설정
+    PUT(FTRP(bp), PACK(size, 0)); // 병합된 블록의 푸터 설정
+    FIT_MOVED(bp, NEXT_BLKP(bp), bp); // next-fit: rover가 병합되는 영역에 있었다면 새 블록 시작점으로 이동
+    FREE_INSERT(bp); // 병합된 블록을 새로운 크기에 맞게 가용 자료구조에 추가
+    return bp;
 #endif
 }
 
-/******************************** find_fit ************************************/
+/********************************** place *************************************/
 /*
- * find_fit - 적합한 가용 블록 찾기 (정책에 따라 다른 구현)
- * 요청된 크기 이상의 가용 블록을 찾아 반환한다.
+ * place - 블록에 요청 크기만큼 할당하고 필요시 분할
+ * 찾은 가용 블록에 요청된 크기를 할당하고, 남는 공간이 충분하면 새 가용 블록으로 분할한다.
  */
-static void *find_fit(size_t asize)
+static void place(void *bp, size_t asize)
 {
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-    // 명시적 first-fit: 가용 리스트를 처음부터 순회하며 첫 번째 적합한 블록 반환
-    for (char *bp = free_listp; bp != NULL; bp = NEXT_FREEP(bp)) {
-        if (GET_SIZE(HDRP(bp)) >= asize) return bp; // 요청 크기 이상이면 즉시 반환
+    size_t csize = GET_SIZE(HDRP(bp)); // 현재 가용 블록의 전체 크기
+
+#if ALLOC_POLICY == POLICY_BUDDY
+    // 버디: 요청 크기가 될 때까지 반으로 나누고 위쪽 절반을 가용 리스트로 돌려보냄
+    remove_buddy_block(bp);
+    while (csize > asize) {
+        csize >>= 1;
+        char *upper = (char *)bp + csize; // 위쪽 절반의 payload
+        PUT(HDRP(upper), PACK(csize, 0));
+        insert_buddy_block(upper);
     }
-    return NULL; // 적합한 블록 없음
-#elif ALLOC_POLICY == POLICY_IMPLICIT_NF
-    // 암시적 next-fit: rover 위치부터 힙 끝까지 탐색
-    char *bp;
-    // 첫 번째 탐색: rover에서 힙 끝까지
-    for (bp = rover; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
-        // 가용블록이고 요청 크기 이상이면 적합
-        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) {
-            rover = bp; // 찾은 위치를 rover에 기록하여 다음 탐색 시작점으로 설정
-            return bp;
+    PUT(HDRP(bp), PACK(csize, 1));
+#else
+    FREE_REMOVE(bp); // 할당하기 전에 가용 자료구조에서 제거
+
+    // 할당 후 남는 공간이 최소 블록 크기 이상이면 분할
+    if (csize - asize >= MIN_BLOCK) {
+        /* allocate front part - 앞 부분을 요청 크기로 할당 */
+        PUT(HDRP(bp), PACK(asize, GET_PREV_ALLOC(HDRP(bp)) | 1)); // 할당 블록의 헤더 설정 (할당 블록은 푸터 없음)
+
+        /* create a new free block with the remainder - 남는 부분으로 새 가용 블록 생성 */
+        void *nbp = NEXT_BLKP(bp); // 분할된 새 블록의 시작 위치
+        size_t rem = csize - asize; // 남는 크기 계산
+        PUT(HDRP(nbp), PACK(rem, PREV_ALLOC)); // 새 가용 블록의 헤더 설정 (앞 블록은 방금 할당됨)
+        PUT(FTRP(nbp), PACK(rem, 0)); // 새 가용 블록의 푸터 설정
+        // 그 다음 블록의 prev-alloc 비트는 원래 가용 블록 뒤였으므로 이미 0
+
+        FREE_INSERT(nbp); // 새 가용 블록을 가용 자료구조에 추가
+        FIT_PLACED(nbp); // next-fit: 분할된 가용 블록을 다음 탐색 시작점으로 설정
+    } else {
+        /* consume entire block - 블록 전체를 할당 (분할하지 않음) */
+        PUT(HDRP(bp), PACK(csize, GET_PREV_ALLOC(HDRP(bp)) | 1)); // 전체 블록 할당으로 헤더 설정
+        SET_PREV_ALLOC(HDRP(NEXT_BLKP(bp))); // 다음 블록에 앞 블록이 할당됐음을 알림
+        FIT_PLACED(NEXT_BLKP(bp)); // next-fit: 할당된 블록 다음을 탐색 시작점으로 설정
+    }
+#endif
+}
+
+/******************************* Heap trimming ********************************/
+#if MM_TRIM
+/*
+ * 해제로 생긴 큰 가용 블록의 메모리를 OS에 돌려준다 (glibc의 trim/MADV_DONTNEED와 같은 역할).
+ *   - 힙(세그먼트) 맨 끝의 TRIM_THRESHOLD 이상 가용 블록: TRIM_KEEP만 남기고 brk를 내린다 (mem_shrink).
+ *     MM_THREADS 빌드에서는 그 세그먼트가 memlib 힙의 맨 끝일 때만 가능하다.
+ *     버디는 블록을 쪼갤 수 없으므로 블록을 통째로 떼어 낸다.
+ *   - 그 밖에 DECOMMIT_THRESHOLD 이상 블록을 해제하면 그 블록이 차지하던 페이지를 반납한다 (mem_decommit).
+ *     병합된 이웃은 다시 반납하지 않는다 (큰 이웃은 자기가 해제될 때 이미 반납됨).
+ *     헤더/링크/푸터 자리는 남기고, 주소 범위는 그대로라 나중에 할당되면 0으로 채워진 새 페이지가 붙는다.
+ */
+
+/*
+ * trim_top - 힙 끝 가용 블록 bp를 줄이고 brk를 내림. 줄였으면 1 (호출자가 아레나 락을 잡고 있음)
+ */
+static int trim_top(void *bp)
+{
+    size_t size = GET_SIZE(HDRP(bp));
+    char *end = (char *)bp + size; // bp 다음 블록의 payload = 에필로그 다음 주소
+
+    if (size < TRIM_THRESHOLD || GET_SIZE(HDRP(end)) != 0)
+        return 0; // 작거나 뒤에 에필로그가 아닌 블록이 있음
+    HEAP_LOCK();
+    if (end != (char *)mem_heap_hi() + 1) { // 다른 아레나 세그먼트가 위에 있음
+        HEAP_UNLOCK();
+        return 0;
+    }
+    FREE_REMOVE(bp);
+#if ALLOC_POLICY == POLICY_BUDDY
+    PUT(HDRP(bp), PACK(0, 1)); // 블록 자리가 새 에필로그
+    mem_shrink(size);
+#else
+    FIT_MOVED(bp, end, bp); // rover가 잘려 나갈 영역(과 옛 에필로그)을 가리키지 않도록
+    PUT(HDRP(bp), PACK(TRIM_KEEP, GET_PREV_ALLOC(HDRP(bp))));
+    PUT(FTRP(bp), PACK(TRIM_KEEP, 0));
+    PUT(HDRP(NEXT_BLKP(bp)), PACK(0, 1)); // 새 에필로그 (앞 블록은 가용)
+    FREE_INSERT(bp);
+    mem_shrink(size - TRIM_KEEP);
+#endif
+#ifdef MM_THREADS
+    arena->top = (char *)mem_heap_hi() + 1;
+#endif
+    HEAP_UNLOCK();
+    return 1;
+}
+
+/*
+ * release_pages - 병합된 가용 블록 bp 중 방금 해제한 범위 [lo, hi)의 메모리를 OS에 돌려줌
+ * (호출자가 아레나 락을 잡고 있음)
+ */
+static void release_pages(void *bp, char *lo, char *hi)
+{
+    if (trim_top(bp) || (size_t)(hi - lo) < DECOMMIT_THRESHOLD)
+        return;
+    lo = MAX(lo, (char *)bp + DECOMMIT_SKIP);                  // 링크 자리는 남김
+    hi = MIN(hi, (char *)bp + GET_SIZE(HDRP(bp)) - DSIZE);     // 푸터(와 다음 헤더)는 남김
+    mem_decommit(lo, hi - lo);
+}
+#endif
+
+/**************************** Decay purging (MM_DECAY) **************************/
+#if MM_DECAY
+/*
+ * 큰 블록을 해제해도 mm_free가 그 페이지를 바로 반납하지 않고, 백그라운드 워커가 시간이 지나면서
+ * 천천히 반납한다 (jemalloc의 dirty page decay와 같은 방식).
+ *   - free_block은 해제한 페이지 수를 아레나의 decay_new에 더하기만 한다.
+ *   - 워커는 decay_ms / DECAY_EPOCHS마다 깨어나 아레나별로 최근 DECAY_EPOCHS개 구간의 해제량
+ *     (decay_backlog)에 smootherstep 감쇠 곡선을 곱해 합한 값을 남겨 둘 dirty 페이지 허용치로 삼는다.
+ *     방금 해제한 페이지는 허용치에 그대로 들어가므로 곧 재사용되는 메모리는 반납되지 않고,
+ *     decay_ms가 지나면 허용치가 0이 된다.
+ *   - 가용 블록 안의 상주(resident) 페이지가 허용치를 넘으면 아레나 락을 잡고 세그먼트를 순회하며
+ *     페이지보다 큰 가용 블록의 내부 페이지를 넘는 만큼 반납한다 (mem_decommit).
+ *   - 반납한 페이지는 비트맵에 기록해 두었다가 다시 상주하면 refault로 센다.
+ * 감쇠 시간은 DECAY_MS (컴파일 시) 또는 환경 변수 MM_DECAY_MS (밀리초, 첫 mm_init 때)로 정한다.
+ */
+#  include <time.h>
+#  define DECAY_PAGE_ROUND(p)  ((char *)(((uintptr_t)(p) + DECAY_PAGE - 1) & ~(uintptr_t)(DECAY_PAGE - 1)))
+#  define DECAY_PAGE_TRUNC(p)  ((char *)((uintptr_t)(p) & ~(uintptr_t)(DECAY_PAGE - 1)))
+
+static pthread_t decay_thread;
+static int decay_running, decay_stop;                  /* 워커 상태 (decay_lock 아래서 변경) */
+static long decay_interval_ms;                         /* 워커가 깨어나는 간격 */
+static double decay_curve[DECAY_EPOCHS];               /* 구간 나이별로 남겨 둘 비율 (1 -> 0) */
+static uint64_t purged_pages[ARENA_MAX_GRANULES / 64]; /* 워커가 반납한 페이지 (mem_heap_lo 기준) */
+static size_t decay_npurged, decay_nrefaulted;         /* 반납한 페이지 / 반납 후 다시 상주한 페이지 */
+
+/*
+ * decay_resident - 페이지 정렬된 [lo, hi) 중 상주 페이지 수 (반납 대상이면 반납하고 비트맵에 기록)
+ */
+static size_t decay_resident(char *lo, char *hi, int purge)
+{
+    unsigned char vec[64];
+    size_t n = 0;
+
+    for (char *p = lo; p < hi; p += sizeof(vec) * DECAY_PAGE) {
+        size_t npages = MIN(sizeof(vec), (size_t)(hi - p) / DECAY_PAGE);
+        if (mem_incore(p, npages * DECAY_PAGE, vec) < 0) continue;
+        for (size_t i = 0; i < npages; i++)
+            n += vec[i] & 1;
+    }
+    if (purge && n > 0) {
+        mem_decommit(lo, hi - lo);
+        for (char *p = lo; p < hi; p += DECAY_PAGE) {
+            size_t pg = (size_t)(p - (char *)mem_heap_lo()) / DECAY_PAGE;
+            purged_pages[pg / 64] |= (uint64_t)1 << (pg % 64);
         }
+        decay_npurged += n;
     }
-    // 두 번째 탐색: 힙 시작에서 rover 이전까지 (순환 탐색)
-    for (bp = heap_listp; bp < rover; bp = NEXT_BLKP(bp)) {
-        // 가용블록이고 요청 크기 이상이면 적합
-        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) {
-            rover = bp; // 찾은 위치를 rover에 기록하여 다음 탐색 시작점으로 설정
-            return bp;
+    return n;
+}
+
+/*
+ * decay_scan - 아레나 a의 세그먼트들을 순회하며 가용 블록 안 상주 페이지를 세고,
+ * 그중 quota 페이지 이상을 (블록 단위로) 반납. 반납하지 않고 남은 상주 페이지 수를 반환
+ * (호출자가 a의 락을 잡고 있음)
+ */
+static size_t decay_scan(arena_t *a, size_t quota)
+{
+    char *lo = mem_heap_lo();
+    size_t dirty = 0;
+    uint8_t id = (uint8_t)(a - arenas);
+
+    HEAP_LOCK();
+    size_t ngran = ((size_t)((char *)mem_heap_hi() + 1 - lo) + ARENA_GRANULE - 1) >> ARENA_GRANULE_LOG2;
+    HEAP_UNLOCK();
+    for (size_t g = 0; g < ngran; g++) {
+        // 세그먼트는 granule 경계에서 시작하고 granule을 다른 아레나와 나누지 않으므로
+        // 소유 아레나가 바뀌는 granule이 a의 세그먼트 시작 (| pad | prologue hdr | prologue ftr | 첫 블록)
+        if (arena_owner[g] != id || (g > 0 && arena_owner[g - 1] == id)) continue;
+        for (char *bp = lo + (g << ARENA_GRANULE_LOG2) + 4*WSIZE; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+            if (GET_ALLOC(HDRP(bp))) continue;
+            char *plo = DECAY_PAGE_ROUND(bp + DECOMMIT_SKIP);                    // 링크 자리는 남김
+            char *phi = DECAY_PAGE_TRUNC(bp + GET_SIZE(HDRP(bp)) - DSIZE);       // 푸터(와 다음 헤더)는 남김
+            if (phi <= plo) continue;
+            size_t n = decay_resident(plo, phi, quota > 0);
+            if (quota > 0) quota -= MIN(quota, n);
+            else dirty += n;
         }
     }
-    return NULL; // 적합한 블록 없음
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-    // 분리 가용 리스트 + best-fit: 해당 크기 클래스부터 시작해서 best-fit 탐색
-    int start_class = get_size_class(asize);
-    void *best_bp = NULL;
-    size_t best_size = SIZE_MAX;
-    
-    // 요청 크기에 맞는 클래스부터 시작해서 상위 클래스들을 순회
-    for (int class = start_class; class < SEGREGATED_CLASSES; class++) {
-        // 해당 클래스의 리스트를 순회하며 best-fit 찾기
-        for (char *bp = segregated_lists[class]; bp != NULL; bp = NEXT_FREEP(bp)) {
-            size_t block_size = GET_SIZE(HDRP(bp));
-            if (block_size >= asize) {
-                // 현재까지 찾은 best보다 더 적합한(작은) 블록이면 업데이트
-                if (block_size < best_size) {
-                    best_bp = bp;
-                    best_size = block_size;
-                    // 정확히 맞는 크기를 찾았으면 즉시 반환 (perfect fit)
-                    if (best_size == asize) return best_bp;
-                }
+    return dirty;
+}
+
+/*
+ * decay_count_refaults - 반납했던 페이지 중 다시 상주하게 된 페이지를 세고 비트맵에서 지움
+ */
+static void decay_count_refaults(void)
+{
+    char *lo = mem_heap_lo();
+    unsigned char vec[64];
+
+    for (size_t w = 0; w < ARENA_MAX_GRANULES / 64; w++) {
+        if (purged_pages[w] == 0) continue;
+        if (mem_incore(lo + w * 64 * DECAY_PAGE, 64 * DECAY_PAGE, vec) < 0) continue;
+        for (int i = 0; i < 64; i++)
+            if ((purged_pages[w] >> i & 1) && (vec[i] & 1)) {
+                purged_pages[w] &= ~((uint64_t)1 << i);
+                decay_nrefaulted++;
             }
+    }
+}
+
+/*
+ * decay_epoch - 한 구간이 지남: 아레나마다 해제 기록을 한 칸 밀고, 상주 가용 페이지가 허용치를 넘으면 반납
+ * (호출자가 decay_lock을 잡고 있음)
+ */
+static void decay_epoch(void)
+{
+    decay_count_refaults();
+    for (int i = 0; i < MM_ARENAS; i++) {
+        ARENA_ENTER(&arenas[i]);
+        drain_remote_frees(); // 소유 스레드가 더 할당하지 않으면 remote 스택의 블록이 계속 남으므로
+        memmove(&arena->decay_backlog[1], &arena->decay_backlog[0], (DECAY_EPOCHS - 1) * sizeof(size_t));
+        arena->decay_backlog[0] = arena->decay_new;
+        arena->decay_dirty += arena->decay_new;
+        arena->decay_new = 0;
+
+        double limit = 0; // 남겨 둘 수 있는 dirty 페이지 수
+        for (int k = 0; k < DECAY_EPOCHS; k++)
+            limit += arena->decay_backlog[k] * decay_curve[k];
+        if (arena->decay_dirty > (size_t)limit) { // 추정치가 넘으면 실제로 세어 보고 넘는 만큼 반납
+            size_t dirty = decay_scan(arena, 0);
+            if (dirty > (size_t)limit)
+                dirty = decay_scan(arena, dirty - (size_t)limit) + (size_t)limit;
+            arena->decay_dirty = dirty;
         }
-        // 해당 클래스에서 적합한 블록을 찾았으면 반환 (하위 클래스에서 찾는 것이 더 효율적)
-        if (best_bp) return best_bp;
+        ARENA_LEAVE();
     }
-    return NULL; // 적합한 블록 없음
-#else /* POLICY_IMPLICIT_FF */
-    // 암시적 first-fit: 힙 시작부터 순회하며 첫 번째 적합한 블록 반환
-    for (char *bp = heap_listp; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
-        // 가용블록이고 요청 크기 이상이면 적합
-        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize) return bp;
+}
+
+/*
+ * decay_worker - 백그라운드 반납 스레드 본체
+ */
+static void *decay_worker(void *unused)
+{
+    struct timespec ts = { decay_interval_ms / 1000, (decay_interval_ms % 1000) * 1000000L };
+
+    (void)unused;
+    for (;;) {
+        nanosleep(&ts, NULL);
+        pthread_mutex_lock(&decay_lock);
+        if (decay_stop) {
+            pthread_mutex_unlock(&decay_lock);
+            return NULL;
+        }
+        decay_epoch();
+        pthread_mutex_unlock(&decay_lock);
     }
-    return NULL; // 적합한 블록 없음
+}
+
+/*
+ * decay_reset - mm_init에서 호출: 감쇠 기록과 카운터를 비우고, 워커가 없으면 시작 (호출자가 decay_lock을 잡고 있음)
+ */
+static void decay_reset(void)
+{
+    for (int i = 0; i < MM_ARENAS; i++) {
+        arenas[i].decay_new = arenas[i].decay_dirty = 0;
+        memset(arenas[i].decay_backlog, 0, sizeof(arenas[i].decay_backlog));
+    }
+    memset(purged_pages, 0, sizeof(purged_pages));
+    decay_npurged = decay_nrefaulted = 0;
+    if (decay_running) return;
+
+    const char *env = getenv("MM_DECAY_MS");
+    long ms = env ? atol(env) : DECAY_MS;
+    if (ms < 0) ms = 0;
+    for (int k = 0; k < DECAY_EPOCHS; k++) { // 1 - smootherstep(나이 / 구간 수), decay_ms = 0이면 모두 0
+        double x = (double)k / DECAY_EPOCHS;
+        decay_curve[k] = ms ? 1.0 - x * x * x * (x * (x * 6 - 15) + 10) : 0.0;
+    }
+    decay_interval_ms = MAX(ms / DECAY_EPOCHS, 1);
+    decay_stop = 0;
+    decay_running = (pthread_create(&decay_thread, NULL, decay_worker, NULL) == 0);
+}
+
+/*
+ * mm_decay_stats - 마지막 mm_init 이후 워커가 반납한 페이지 수와 그중 다시 상주하게 된 페이지 수
+ */
+void mm_decay_stats(size_t *purged, size_t *refaulted)
+{
+    pthread_mutex_lock(&decay_lock);
+    *purged = decay_npurged;
+    *refaulted = decay_nrefaulted;
+    pthread_mutex_unlock(&decay_lock);
+}
+
+/*
+ * mm_decay_shutdown - 워커를 멈추고 기다림 (mem_deinit으로 힙을 없애기 전에 호출). 다음 mm_init이 다시 시작한다.
+ */
+void mm_decay_shutdown(void)
+{
+    pthread_mutex_lock(&decay_lock);
+    int running = decay_running;
+    decay_stop = 1;
+    decay_running = 0;
+    pthread_mutex_unlock(&decay_lock);
+    if (running) pthread_join(decay_thread, NULL);
+}
+#endif
+
+/***************************** Block alloc / free *****************************/
+/*
+ * alloc_block - 현재 아레나에서 asize 크기 블록을 할당 (호출자가 아레나 락을 잡고 있음)
+ * 적합한 가용 블록이 없으면 힙을 확장한다.
+ */
+static void *alloc_block(size_t asize)
+{
+    drain_remote_frees(); // 다른 스레드가 돌려보낸 블록부터 병합해 재사용 가능하게 함
+
+#if MM_QUICK
+    if (asize <= QUICK_MAX_SIZE && arena->quick[asize / DSIZE] != NULL) { // 같은 크기로 해제된 블록을 그대로 (place/분할 없음)
+        char *qp = arena->quick[asize / DSIZE];
+        arena->quick[asize / DSIZE] = QUICK_NEXT(qp);
+        arena->quick_len[asize / DSIZE]--;
+        arena->quick_total--;
+        return qp;
+    }
+#endif
+#if MM_ADAPT_EXTEND
+    arena->nallocs++; // 확장 단위 조절용 할당 속도
+#endif
+    // 적합한 가용 블록 탐색
+    void *bp = find_fit(asize);
+#if MM_QUICK
+    if (bp == NULL && quick_drain()) // 힙을 늘리기 전에 미뤄 둔 해제를 모두 병합하고 다시 탐색
+        bp = find_fit(asize);
 #endif
+    if (bp == NULL) {
+        bp = extend_fit(asize); // 적합한 블록이 없으면 힙 확장
+#if MM_GROW
+        if (bp == NULL && grow_reclaim()) // 힙이 꽉 찼으면 예약해 둔 여유를 회수하고 다시 탐색
+            bp = find_fit(asize);
+#endif
+    }
+    if (bp) place(bp, asize); // 블록에 할당하고 필요시 분할 (확장 실패시 NULL 그대로)
+    return bp;
+}
+
+/*
+ * free_block - 할당된 블록을 가용으로 바꾸고 인접 가용 블록과 병합 (호출자가 소유 아레나 락을 잡고 있음)
+ */
+static void free_block(void *bp)
+{
+    size_t size = GET_SIZE(HDRP(bp)); // 해제할 블록의 크기 확인
+    PUT(HDRP(bp), PACK(size, GET_PREV_ALLOC(HDRP(bp)))); // 헤더를 가용 상태로 변경 (prev-alloc 비트 유지)
+    PUT(FTRP(bp), PACK(size, 0)); // 가용 블록이 되었으므로 푸터 기록
+    CLR_PREV_ALLOC(HDRP(NEXT_BLKP(bp))); // 다음 블록에 앞 블록이 가용됐음을 알림
+#if MM_GROW
+    if (size >= GROW_MIN) grow_forget(bp); // 확장 기록이 있으면 지움
+#endif
+#if MM_TRIM || MM_DECAY
+    char *lo = bp; // 방금 해제한 범위 [lo, lo + size)
+    bp = coalesce(bp); // 인접 가용 블록들과 병합
+#  if MM_DECAY
+    if (size > DECAY_PAGE) arena->decay_new += size / DECAY_PAGE; // 페이지 반납은 워커가 나중에
+#  endif
+#  if MM_TRIM
+    if (GET_SIZE(HDRP(bp)) >= TRIM_THRESHOLD || size >= DECOMMIT_THRESHOLD)
+        release_pages(bp, lo, lo + size); // 힙 끝을 내리거나 방금 해제한 페이지를 반납
+#  else
+    (void)lo;
+#  endif
+#else
+    (void)coalesce(bp); // 인접 가용 블록들과 병합
+#endif
+}
+
+/*
+ * alloc_aligned_block - payload가 align(2의 거듭제곱) 경계에 놓인 asize 크기 블록을 할당
+ * (호출자가 아레나 락을 잡고 있음). 여유 있게 큰 가용 블록을 통째로 잡은 뒤
+ * 정렬 지점 앞뒤로 남는 부분을 다시 가용 블록으로 돌려보낸다.
+ * 슬랩 페이지와 mm_memalign이 사용한다.
+ */
+static void *alloc_aligned_block(size_t asize, size_t align)
+{
+#if ALLOC_POLICY == POLICY_BUDDY
+    // 버디: 2^k 블록의 payload는 min(2^k, BUDDY_ORIGIN_ALIGN)에 정렬되므로 크기만 올리면 된다
+    if (align > BUDDY_ORIGIN_ALIGN) return NULL;
+    return alloc_block(BUDDY_ROUND(MAX(asize, align)));
+#else
+    size_t need = asize + align + MIN_BLOCK; // 앞쪽 자투리가 0이거나 MIN_BLOCK 이상이 되도록 여유
+    drain_remote_frees(); // 다른 스레드가 돌려보낸 블록부터 병합
+    char *bp = find_fit(need);
+#if MM_QUICK
+    if (bp == NULL && quick_drain()) // 힙을 늘리기 전에 미뤄 둔 해제를 모두 병합하고 다시 탐색
+        bp = find_fit(need);
+#endif
+    if (bp == NULL && (bp = extend_fit(need)) == NULL)
+        return NULL;
+    place(bp, GET_SIZE(HDRP(bp))); // 분할 없이 블록 전체를 할당
+
+    size_t csize = GET_SIZE(HDRP(bp));
+    char *abp = (char *)(((uintptr_t)bp + align - 1) & ~(uintptr_t)(align - 1)); // 정렬된 payload 위치
+    if (abp != bp && (size_t)(abp - bp) < MIN_BLOCK) // 앞 자투리가 블록이 될 수 없으면 MIN_BLOCK 이상 떨어진 경계로
+        abp += (MIN_BLOCK - (size_t)(abp - bp) + align - 1) & ~(align - 1);
+
+    if (abp != bp) { // 앞 자투리를 떼어 가용으로 (앞의 가용 블록과 병합됨)
+        size_t lead = abp - bp;
+        PUT(HDRP(abp), PACK(csize - lead, PREV_ALLOC | 1));
+        PUT(HDRP(bp), PACK(lead, GET_PREV_ALLOC(HDRP(bp)) | 1));
+        free_block(bp);
+        bp = abp;
+        csize -= lead;
+    }
+    if (csize - asize >= MIN_BLOCK) { // 뒤에 남는 부분도 가용으로
+        PUT(HDRP(bp), PACK(asize, GET_PREV_ALLOC(HDRP(bp)) | 1));
+        char *rest = NEXT_BLKP(bp);
+        PUT(HDRP(rest), PACK(csize - asize, PREV_ALLOC | 1));
+        free_block(rest);
+    }
+    return bp;
+#endif
+}
+
+/************************ Quick lists (deferred coalescing) ***********************/
+/*
+ * QUICK_MAX_SIZE 이하 블록은 해제되어도 경계 태그를 고치거나 가용 자료구조에 넣지 않고,
+ * 헤더를 할당 상태로 둔 채 아레나의 크기별 단일 연결 리스트(quick list)에 LIFO로 보관한다.
+ *   - 같은 크기의 다음 할당은 alloc_block 맨 앞에서 그 블록을 그대로 받는다 (find_fit/place/coalesce 생략).
+ *   - 보관 중인 블록은 이웃에게 할당 블록으로 보이므로 병합되거나 realloc에 흡수되지 않는다.
+ *   - 한 크기가 QUICK_CAP개를 넘으면 그 크기 리스트를, find_fit이 실패하면 힙을 늘리기 전에
+ *     모든 리스트를 한꺼번에 free_block으로 병합한다.
+ * tcache와 달리 아레나 락 아래에서 동작하므로 MM_THREADS 빌드에서는 원격 해제도 여기로 모인다.
+ * (MM_QUICK 기본값은 스레드 캐시 설정 옆에 있다)
+ */
+#if MM_QUICK
+#  if MM_GROW && GROW_MIN <= QUICK_MAX_SIZE
+#    error "GROW_MIN must be larger than QUICK_MAX_SIZE (tracked blocks must not be deferred)"
+#  endif
+
+/*
+ * quick_flush - bin 크기 리스트의 블록을 모두 병합 (호출자가 아레나 락을 잡고 있음)
+ */
+static void quick_flush(unsigned bin)
+{
+    char *bp = arena->quick[bin];
+    arena->quick[bin] = NULL;
+    arena->quick_total -= arena->quick_len[bin];
+    arena->quick_len[bin] = 0;
+    while (bp != NULL) {
+        char *next = QUICK_NEXT(bp);
+        free_block(bp);
+        bp = next;
+    }
+}
+
+/*
+ * quick_drain - 모든 quick list를 병합. 병합한 블록이 있었으면 1 (호출자가 아레나 락을 잡고 있음)
+ */
+static int quick_drain(void)
+{
+    if (arena->quick_total == 0) return 0;
+    for (unsigned bin = 0; bin < QUICK_BINS; bin++)
+        if (arena->quick[bin] != NULL) quick_flush(bin);
+    return 1;
+}
+
+/*
+ * quick_free - 블록을 크기별 quick list에 넣음. 그 크기가 가득 찼으면 먼저 한꺼번에 병합한다.
+ */
+static void quick_free(void *bp)
+{
+    unsigned bin = GET_SIZE(HDRP(bp)) / DSIZE;
+
+    if (arena->quick_len[bin] >= QUICK_CAP)
+        quick_flush(bin);
+    QUICK_NEXT(bp) = arena->quick[bin];
+    arena->quick[bin] = bp;
+    arena->quick_len[bin]++;
+    arena->quick_total++;
+}
+#endif
+
+/**************************** Slab allocator (MM_SLAB) *************************/
+/*
+ * SLAB_MAX_OBJ 이하의 요청은 크기 클래스마다 페이지 크기 슬랩에서 고정 크기 칸으로 나눠 준다.
+ *   - 슬랩은 payload가 페이지 경계에 놓인 SLAB_SIZE 크기의 평범한 할당 블록이라
+ *     힙 순회, 병합, 아레나 세그먼트와 그대로 어울린다 (마지막 워드는 다음 블록 헤더).
+ *   - 칸에는 헤더/푸터가 없고, 빈 칸은 슬랩 헤더의 비트맵으로만 관리한다.
+ *   - 해제할 때는 포인터의 페이지가 slab_pages에 기록돼 있는지 보고,
+ *     포인터를 SLAB_SIZE로 마스킹해 슬랩 헤더를 찾아 비트 하나를 켠다.
+ *   - 완전히 빈 슬랩은 클래스의 마지막 슬랩이 아니면 블록째 백엔드로 돌려보낸다.
+ * 모든 정책과 MM_THREADS 빌드에서 동작하며, -DMM_SLAB=0으로 끌 수 있다.
+ */
+#if MM_SLAB
+/*
+ * slab_page_index - 주소가 속한 페이지의 slab_pages 인덱스 (mem_heap_lo가 있는 페이지가 0)
+ */
+static inline size_t slab_page_index(void *p)
+{
+    return ((uintptr_t)p >> SLAB_SIZE_LOG2) - ((uintptr_t)mem_heap_lo() >> SLAB_SIZE_LOG2);
+}
+
+/*
+ * in_slab - p가 슬랩 칸을 가리키는지 확인
+ */
+static inline int in_slab(void *p)
+{
+    size_t pg = slab_page_index(p);
+    return pg < SLAB_MAX_PAGES && ((slab_pages[pg >> 6] >> (pg & 63)) & 1);
+}
+
+#  define SLAB_OF(p)           ((slab_t *)((uintptr_t)(p) & ~(uintptr_t)(SLAB_SIZE - 1))) // 칸 포인터 -> 슬랩 헤더
+
+/*
+ * slab_link / slab_unlink - 슬랩을 클래스의 빈 칸 있는 슬랩 리스트에 넣고 뺌
+ */
+static void slab_link(slab_t *s)
+{
+    s->prev = NULL;
+    s->next = arena->slabs[s->cls];
+    if (s->next) s->next->prev = s;
+    arena->slabs[s->cls] = s;
+}
+
+static void slab_unlink(slab_t *s)
+{
+    if (s->prev) s->prev->next = s->next;
+    else arena->slabs[s->cls] = s->next;
+    if (s->next) s->next->prev = s->prev;
+}
+
+/*
+ * slab_new - cls 클래스의 새 슬랩을 백엔드에서 만들어 리스트에 넣음 (실패하면 NULL)
+ */
+static slab_t *slab_new(unsigned cls)
+{
+    drain_remote_frees(); // 새 페이지를 만들기 전에 돌아온 블록부터 병합
+    slab_t *s = alloc_aligned_block(SLAB_SIZE, SLAB_SIZE);
+    if (s == NULL) return NULL;
+    size_t pg = slab_page_index(s);
+    if (pg >= SLAB_MAX_PAGES) { free_block(s); return NULL; } // 기록할 수 없는 위치면 일반 블록으로 처리
+
+    s->cls = cls;
+    s->obj_size = (cls + 1) * ALIGNMENT;
+    s->nobjs = (SLAB_SIZE - WSIZE - SLAB_HDR_SIZE) / s->obj_size; // 마지막 워드는 다음 블록 헤더
+    s->nfree = s->nobjs;
+    memset(s->free_map, 0, sizeof(s->free_map));
+    for (unsigned i = 0; i < s->nobjs; i++)
+        s->free_map[i >> 6] |= (uint64_t)1 << (i & 63);
+    __atomic_fetch_or(&slab_pages[pg >> 6], (uint64_t)1 << (pg & 63), __ATOMIC_RELAXED); // 다른 아레나도 같은 워드를 씀
+    slab_link(s);
+    return s;
+}
+
+/*
+ * slab_alloc - size 바이트 요청에 슬랩 칸 하나를 할당 (호출자가 아레나 락을 잡고 있음)
+ */
+static void *slab_alloc(size_t size)
+{
+    unsigned cls = (size - 1) / ALIGNMENT;
+    slab_t *s = arena->slabs[cls];
+    if (s == NULL && (s = slab_new(cls)) == NULL) return NULL;
+
+    unsigned w = 0;
+    while (s->free_map[w] == 0) w++; // 리스트에 있는 슬랩은 빈 칸이 반드시 있음
+    unsigned i = (w << 6) + __builtin_ctzll(s->free_map[w]);
+    s->free_map[w] &= s->free_map[w] - 1; // 가장 낮은 빈 칸 사용
+    if (--s->nfree == 0) slab_unlink(s); // 가득 찬 슬랩은 리스트에서 뺌
+    return (char *)s + SLAB_HDR_SIZE + (size_t)i * s->obj_size;
+}
+
+/*
+ * slab_free - 슬랩 칸을 비움 (호출자가 소유 아레나 락을 잡고 있음)
+ */
+static void slab_free(void *p)
+{
+    slab_t *s = SLAB_OF(p);
+    unsigned i = (unsigned)(((char *)p - (char *)s - SLAB_HDR_SIZE) / s->obj_size);
+    s->free_map[i >> 6] |= (uint64_t)1 << (i & 63);
+
+    if (++s->nfree == 1) { slab_link(s); return; } // 가득 찼던 슬랩이 다시 쓸 수 있게 됨
+    if (s->nfree == s->nobjs && (s->prev != NULL || s->next != NULL)) {
+        // 완전히 빈 슬랩은 (클래스의 마지막 슬랩이 아니면) 블록째 반환
+        size_t pg = slab_page_index(s);
+        slab_unlink(s);
+        __atomic_fetch_and(&slab_pages[pg >> 6], ~((uint64_t)1 << (pg & 63)), __ATOMIC_RELAXED);
+        free_block(s);
+    }
+}
+
+/*
+ * slab_obj_size - 슬랩 칸의 크기 (슬랩이 살아 있는 동안 바뀌지 않으므로 락 없이 읽음)
+ */
+static inline size_t slab_obj_size(void *p)
+{
+    return SLAB_OF(p)->obj_size;
+}
+#endif
+
+/*
+ * release_object - 블록이든 슬랩 칸이든 해제 (호출자가 소유 아레나 락을 잡고 있음)
+ */
+static inline void release_object(void *bp)
+{
+#if MM_SLAB
+    if (in_slab(bp)) { slab_free(bp); return; }
+#endif
+#if MM_QUICK
+    if (GET_SIZE(HDRP(bp)) <= QUICK_MAX_SIZE) { quick_free(bp); return; } // 작은 블록은 병합을 미룸
+#endif
+    free_block(bp);
+}
+
+/*************************** Remote frees (MM_THREADS) ************************/
+#ifdef MM_THREADS
+#  define REMOTE_NEXT(bp)      (*(char **)(bp)) // remote_free 스택 안 블록의 payload 첫 워드 - 다음 블록
+
+/*
+ * remote_free_push - 다른 아레나 소유 블록을 그 아레나의 remote_free 스택에 넣음 (락 없음, CAS 한 번)
+ * 블록은 헤더상 여전히 할당 상태라 소유 아레나가 꺼낼 때까지 아무도 건드리지 않는다.
+ */
+static void remote_free_push(arena_t *owner, void *bp)
+{
+    char *head = __atomic_load_n(&owner->remote_free, __ATOMIC_RELAXED);
+    do {
+        REMOTE_NEXT(bp) = head;
+    } while (!__atomic_compare_exchange_n(&owner->remote_free, &head, (char *)bp, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * drain_remote_frees - 현재 아레나의 remote_free 스택을 통째로 가져와 정상 해제 경로로 병합
+ * (호출자가 아레나 락을 잡고 있음). 스택 전체를 exchange로 가져가므로 ABA 문제가 없다.
+ */
+static void drain_remote_frees(void)
+{
+    if (__atomic_load_n(&arena->remote_free, __ATOMIC_RELAXED) == NULL) return; // 대부분 비어 있음
+    char *bp = __atomic_exchange_n(&arena->remote_free, NULL, __ATOMIC_ACQUIRE);
+    while (bp != NULL) {
+        char *next = REMOTE_NEXT(bp);
+        release_object(bp);
+        bp = next;
+    }
+}
+
+/*
+ * release_block - 블록(또는 슬랩 칸)을 소유 아레나로 돌려보냄: 내 아레나면 락을 잡고 바로 병합, 아니면 remote 스택으로
+ */
+static void release_block(void *bp)
+{
+    arena_t *owner = arena_of(bp);
+    if (owner != thread_arena()) { // 다른 스레드의 아레나: 소유자의 락을 다투지 않음
+        remote_free_push(owner, bp);
+        return;
+    }
+    ARENA_ENTER(owner);
+    release_object(bp);
+    drain_remote_frees(); // 락을 잡은 김에 쌓인 remote 해제도 병합
+    ARENA_LEAVE();
+}
+#endif
+
+/************************ Thread cache (tcache) front-end **********************/
+/*
+ * 작은 블록(블록 크기 TCACHE_MAX_SIZE 이하)은 해제되어도 곧바로 병합하지 않고
+ * 스레드 전용 캐시에 크기별(8B 단위) LIFO로 보관했다가 같은 크기의 다음 malloc에 그대로 돌려준다.
+ *   - 캐시 안의 블록은 헤더상 여전히 "할당됨"이라 이웃이 병합하거나 realloc이 흡수하지 않는다.
+ *   - 캐시 적중 시 락/원자 연산 없이 포인터 두 개만 바꾼다 (find_fit/place/coalesce 생략).
+ *   - 미스가 나면 아레나 락을 한 번 잡고 TCACHE_BATCH개까지 채워 오고 (힙 확장 없이 가용 블록에서만),
+ *     클래스가 가득 차면 TCACHE_BATCH개를 한꺼번에 백엔드로 돌려보낸다.
+ *   - mm_init은 heap_gen을 올려 옛 힙을 가리키는 캐시를 무효화하고, 스레드 종료 시 캐시를 비운다.
+ * MM_THREADS 빌드에서는 기본으로 켜지고, 단일 스레드 빌드는 -DMM_TCACHE=1로 켤 수 있다.
+ * (MM_TCACHE 기본값은 아레나 설정 옆에 있다)
+ */
+#if MM_TCACHE
+#  ifndef TCACHE_MAX_SIZE
+#    define TCACHE_MAX_SIZE    1024 // 캐시할 최대 블록 크기 (헤더 포함)
+#  endif
+#  ifndef TCACHE_CAP
+#    define TCACHE_CAP         7    // 크기 클래스당 최대 보관 블록 수 (클수록 적중률은 오르지만 묶여 있는 메모리가 늘어남)
+#  endif
+#  define TCACHE_BATCH         (TCACHE_CAP / 2) // 한 번에 채우거나 돌려보내는 블록 수
+#  define TCACHE_BINS          (TCACHE_MAX_SIZE / DSIZE + 1) // 블록 크기 8B 단위 클래스
+#  define TC_NEXT(bp)          (*(char **)(bp)) // 캐시 안 블록의 payload 첫 워드 - 다음 캐시 블록
+
+typedef struct {
+    unsigned gen;                  /* 캐시를 채운 힙 세대 - heap_gen과 다르면 옛 힙의 블록 */
+    unsigned count[TCACHE_BINS];   /* 클래스별 보관 블록 수 */
+    char *head[TCACHE_BINS];       /* 클래스별 LIFO 머리 (블록 크기 >= 클래스 * 8) */
+} tcache_t;
+
+static __thread tcache_t tcache;   /* 스레드 전용 캐시 */
+
+/*
+ * tcache_flush - bin 클래스에서 최대 n개 블록을 꺼내 소유 아레나로 돌려보냄
+ * 같은 아레나의 블록이 이어지는 동안에는 락을 다시 잡지 않는다.
+ */
+static void tcache_flush(tcache_t *tc, unsigned bin, unsigned n)
+{
+#  ifdef MM_THREADS
+    arena_t *held = NULL; // 현재 잡고 있는 아레나
+#  endif
+    while (n-- > 0 && tc->head[bin] != NULL) {
+        char *bp = tc->head[bin];
+        tc->head[bin] = TC_NEXT(bp);
+        tc->count[bin]--;
+#  ifdef MM_THREADS
+        arena_t *owner = arena_of(bp);
+        if (owner != thread_arena()) { // 다른 아레나 블록은 락 없이 remote 스택으로
+            remote_free_push(owner, bp);
+            continue;
+        }
+        if (owner != held) {
+            ARENA_ENTER(owner);
+            held = owner;
+        }
+#  endif
+        free_block(bp);
+    }
+#  ifdef MM_THREADS
+    if (held) ARENA_LEAVE();
+#  endif
+}
+
+#  ifdef MM_THREADS
+/*
+ * tcache_thread_exit - 스레드 종료 시 캐시의 모든 블록을 백엔드로 돌려보냄
+ */
+static void tcache_thread_exit(void *p)
+{
+    tcache_t *tc = p;
+    if (tc->gen != heap_gen) return; // 옛 힙의 블록은 돌려보낼 곳이 없음
+    for (unsigned bin = 0; bin < TCACHE_BINS; bin++)
+        tcache_flush(tc, bin, TCACHE_CAP);
+}
+#  endif
+
+/*
+ * tcache_sync - 캐시가 현재 힙 세대의 것인지 확인하고, 아니면 비운다
+ */
+static inline tcache_t *tcache_sync(void)
+{
+    tcache_t *tc = &tcache;
+    if (tc->gen != heap_gen) {
+        memset(tc, 0, sizeof(*tc)); // 옛 힙을 가리키는 블록은 버림 (mm_init이 힙을 새로 만들었음)
+        tc->gen = heap_gen;
+#  ifdef MM_THREADS
+        pthread_setspecific(tcache_key, tc); // 종료 시 tcache_thread_exit 호출되도록 등록
+#  endif
+    }
+    return tc;
+}
+
+/*
+ * tcache_alloc - 캐시에서 asize 블록을 꺼냄. 비어 있으면 락 한 번으로 한 묶음을 채워 온다.
+ */
+static void *tcache_alloc(size_t asize)
+{
+    tcache_t *tc = tcache_sync();
+    unsigned bin = asize / DSIZE;
+    char *bp = tc->head[bin];
+
+    if (bp != NULL) { // 적중: 락 없이 LIFO에서 꺼냄
+        tc->head[bin] = TC_NEXT(bp);
+        tc->count[bin]--;
+        return bp;
+    }
+
+    // 미스: 하나는 반환하고, 이미 있는 가용 블록으로 TCACHE_BATCH-1개를 더 채워 둠
+    ARENA_ENTER(thread_arena());
+    bp = alloc_block(asize);
+    for (unsigned i = 1; bp != NULL && i < TCACHE_BATCH; i++) {
+        char *extra = find_fit(asize);
+        if (extra == NULL) break; // 캐시를 채우려고 힙을 늘리지는 않음
+        place(extra, asize);
+        TC_NEXT(extra) = tc->head[bin];
+        tc->head[bin] = extra;
+        tc->count[bin]++;
+    }
+    ARENA_LEAVE();
+    return bp;
+}
+
+/*
+ * tcache_free - 블록을 크기 클래스의 캐시에 넣음. 가득 찼으면 한 묶음을 먼저 돌려보낸다.
+ */
+static void tcache_free(void *bp)
+{
+    tcache_t *tc = tcache_sync();
+    unsigned bin = GET_SIZE(HDRP(bp)) / DSIZE;
+
+    if (tc->count[bin] >= TCACHE_CAP)
+        tcache_flush(tc, bin, TCACHE_BATCH);
+    TC_NEXT(bp) = tc->head[bin];
+    tc->head[bin] = bp;
+    tc->count[bin]++;
+}
+#endif
+
+/**************************** Large blocks (MM_MMAP) ***************************/
+/*
+ * MMAP_THRESHOLD 이상의 요청은 경계 태그 힙을 거치지 않고 memlib의 익명 매핑 하나를 통째로 받는다.
+ *   - 매핑 | 패딩(4) | 헤더(4) | payload ... | 형태이고, 헤더에는 (매핑 길이 | MMAPPED | 할당) 비트를 둔다.
+ *   - 해제하면 매핑을 바로 돌려주므로 힙 가운데 큰 구멍이 남지 않는다.
+ *   - realloc은 mremap으로 페이지 테이블만 바꿔 늘리거나 줄인다 (memcpy 없음).
+ * 매핑을 얻지 못하면 평소처럼 힙에서 할당한다.
+ */
+#if MM_MMAP
+#  define MMAP_OFFSET          ALIGNMENT // 매핑 시작 -> payload (패딩 + 헤더, ALIGNMENT 정렬 유지)
+#  define IS_MMAPPED(bp)       (GET(HDRP(bp)) & MMAPPED) // 슬랩 칸에는 헤더가 없으니 in_slab을 먼저 확인
+
+/*
+ * mmap_length - size 바이트 payload를 담을 매핑 길이 (페이지 단위로 올림)
+ */
+static inline size_t mmap_length(size_t size)
+{
+    size_t pagesize = mem_pagesize();
+    return (size + MMAP_OFFSET + pagesize - 1) & ~(pagesize - 1);
+}
+
+/*
+ * mmap_alloc - 새 매핑에 size 바이트 블록을 만듦 (실패하면 NULL)
+ */
+static void *mmap_alloc(size_t size)
+{
+    size_t len = mmap_length(size);
+    HEAP_LOCK();
+    char *m = mem_map(len);
+    HEAP_UNLOCK();
+    if (m == (void *)-1) return NULL;
+
+    char *bp = m + MMAP_OFFSET;
+    PUT(HDRP(bp), PACK(len, MMAPPED | PREV_ALLOC | 1)); // 앞/뒤 블록이 없으므로 병합 대상이 되지 않음
+    return bp;
+}
+
+/*
+ * mmap_free - 블록의 매핑을 통째로 반환
+ */
+static void mmap_free(void *bp)
+{
+    HEAP_LOCK();
+    mem_unmap((char *)bp - MMAP_OFFSET, GET_SIZE(HDRP(bp)));
+    HEAP_UNLOCK();
 }
 
-/********************************** place *************************************/
 /*
- * place - 블록에 요청 크기만큼 할당하고 필요시 분할
- * 찾은 가용 블록에 요청된 크기를 할당하고, 남는 공간이 충분하면 새 가용 블록으로 분할한다.
+ * mmap_realloc - 매핑을 size 바이트 payload에 맞게 mremap (복사 없음, 주소는 바뀔 수 있음)
  */
-static void place(void *bp, size_t asize)
+static void *mmap_realloc(void *bp, size_t size)
 {
-    size_t csize = GET_SIZE(HDRP(bp)); // 현재 가용 블록의 전체 크기
-
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-    remove_free_block(bp); // 명시적: 할당하기 전에 가용 리스트에서 제거
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-    remove_segregated_block(bp); // 분리: 할당하기 전에 해당 클래스 리스트에서 제거
-#endif
-
-    // 할당 후 남는 공간이 최소 블록 크기 이상이면 분할
-    if (csize - asize >= MIN_BLOCK) {
-        /* allocate front part - 앞 부분을 요청 크기로 할당 */
-        PUT(HDRP(bp), PACK(asize, 1)); // 할당 블록의 헤더 설정
-        PUT(FTRP(bp), PACK(asize, 1)); // 할당 블록의 푸터 설정
+    size_t old = GET_SIZE(HDRP(bp));
+    size_t len = mmap_length(size);
+    if (len == old) return bp; // 같은 페이지 수 - 할 일 없음
 
-        /* create a new free block with the remainder - 남는 부분으로 새 가용 블록 생성 */
-        void *nbp = NEXT_BLKP(bp); // 분할된 새 블록의 시작 위치
-        size_t rem = csize - asize; // 남는 크기 계산
-        PUT(HDRP(nbp), PACK(rem, 0)); // 새 가용 블록의 헤더 설정
-        PUT(FTRP(nbp), PACK(rem, 0)); // 새 가용 블록의 푸터 설정
+    HEAP_LOCK();
+    char *m = mem_remap((char *)bp - MMAP_OFFSET, old, len);
+    HEAP_UNLOCK();
+    if (m == (void *)-1) return NULL; // 실패하면 원래 블록은 그대로 유효
 
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-        insert_free_block(nbp); // 명시적: 새 가용 블록을 리스트에 추가
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-        insert_segregated_block(nbp); // 분리: 새 가용 블록을 해당 클래스 리스트에 추가
-#elif ALLOC_POLICY == POLICY_IMPLICIT_NF
-        rover = nbp; // next-fit: 분할된 가용 블록을 다음 탐색 시작점으로 설정
-#endif
-    } else {
-        /* consume entire block - 블록 전체를 할당 (분할하지 않음) */
-        PUT(HDRP(bp), PACK(csize, 1)); // 전체 블록 할당으로 헤더 설정
-        PUT(FTRP(bp), PACK(csize, 1)); // 전체 블록 할당으로 푸터 설정
-#if ALLOC_POLICY == POLICY_IMPLICIT_NF
-        rover = NEXT_BLKP(bp); // next-fit: 할당된 블록 다음을 탐색 시작점으로 설정
-#endif
-    }
+    bp = m + MMAP_OFFSET;
+    PUT(HDRP(bp), PACK(len, MMAPPED | PREV_ALLOC | 1));
+    return bp;
 }
+#else
+#  define IS_MMAPPED(bp)       0 // 매핑된 블록 없음
+#endif
 
 /********************************* API: malloc ********************************/
 /*
  * mm_malloc - 요청 크기만큼 메모리 블록 할당
- * 8바이트 정렬된 블록을 할당하고, 적합한 블록이 없으면 힙을 확장한다.
+ * ALIGNMENT(8 또는 16)바이트 정렬된 블록을 할당하고, 적합한 블록이 없으면 힙을 확장한다.
  */
 void *mm_malloc(size_t size)
 {
     if (size == 0) return NULL; // 0 바이트 요청시 NULL 반환
 
-    // 요청 크기에 헤더/푸터 오버헤드 추가하고 8바이트 정렬
-    size_t asize = ALIGN(size + DSIZE);      /* add overhead and align - 헤더(4)+푸터(4) 8B 오버헤드 추가 후 8의 배수로 정렬 */
-    if (asize < MIN_BLOCK) asize = MIN_BLOCK; /* enforce policy minimum - 정책별 최소 블록 크기 보장 */
+#if MM_MMAP
+    if (size >= MMAP_THRESHOLD) { // 큰 요청은 자기 매핑으로
+        void *p = mmap_alloc(size);
+        if (p != NULL) return p; // 매핑을 못 얻으면 힙에서
+    }
+#endif
 
-    // 적합한 가용 블록 탐색
-    void *bp = find_fit(asize);
-    if (bp) { // 적합한 블록을 찾았다면
-        place(bp, asize); // 블록에 할당하고 필요시 분할
-        return bp; // 할당된 블록의 payload 포인터 반환
+#if MM_SLAB
+    if (size <= SLAB_MAX_OBJ) { // 작은 요청은 슬랩 칸으로 (헤더 오버헤드 없음)
+        ARENA_ENTER(thread_arena());
+        void *p = slab_alloc(size);
+        ARENA_LEAVE();
+        if (p != NULL) return p; // 슬랩을 만들 수 없으면 일반 블록으로
     }
+#endif
+
+    // 요청 크기에 헤더/푸터 오버헤드 추가하고 ALIGNMENT 정렬
+    size_t asize = ALIGN(size + WSIZE);      /* add overhead and align - 할당 블록은 헤더(4)만 오버헤드, ALIGNMENT의 배수로 정렬 */
+    if (asize < MIN_BLOCK) asize = MIN_BLOCK; /* enforce policy minimum - 정책별 최소 블록 크기 보장 */
+#if ALLOC_POLICY == POLICY_BUDDY
+    asize = BUDDY_ROUND(asize); // 버디: 2의 거듭제곱으로 올림
+#endif
 
-    // 적합한 블록이 없으면 힙 확장
-    size_t extendsize = MAX(asize, CHUNKSIZE); // 요청 크기와 기본 확장 크기 중 큰 값
-    bp = extend_heap(extendsize/WSIZE); // 워드 단위로 힙 확장
-    if (bp == NULL) return NULL; // 확장 실패시 NULL 반환
-    place(bp, asize); // 확장된 블록에 할당
+#if MM_TCACHE
+    if (asize <= TCACHE_MAX_SIZE) return tcache_alloc(asize); // 작은 블록은 스레드 캐시 우선
+#endif
+
+    ARENA_ENTER(thread_arena()); // 이 스레드의 아레나에서 할당
+    void *bp = alloc_block(asize);
+    ARENA_LEAVE();
     return bp; // 할당된 블록의 payload 포인터 반환
 }
 
@@ -587,16 +2540,218 @@ void *mm_malloc(size_t size)
 void mm_free(void *ptr)
 {
     if (ptr == NULL) return; // NULL 포인터는 무시
-    size_t size = GET_SIZE(HDRP(ptr)); // 해제할 블록의 크기 확인
-    PUT(HDRP(ptr), PACK(size, 0)); // 헤더를 가용 상태로 변경
-    PUT(FTRP(ptr), PACK(size, 0)); // 푸터를 가용 상태로 변경
-    (void)coalesce(ptr); // 인접 가용 블록들과 병합
+
+#if MM_SLAB
+    if (in_slab(ptr)) { // 슬랩 칸에는 헤더가 없으므로 캐시 크기 검사보다 먼저
+#  ifdef MM_THREADS
+        release_block(ptr);
+#  else
+        slab_free(ptr);
+#  endif
+        return;
+    }
+#endif
+
+#if MM_MMAP
+    if (IS_MMAPPED(ptr)) { mmap_free(ptr); return; } // 매핑째 반환 (아레나와 무관)
+#endif
+
+#if MM_TCACHE
+    if (GET_SIZE(HDRP(ptr)) <= TCACHE_MAX_SIZE) { tcache_free(ptr); return; } // 작은 블록은 스레드 캐시로
+#endif
+
+#ifdef MM_THREADS
+    release_block(ptr); // 소유 아레나로 (다른 스레드 아레나면 lock-free remote 스택으로)
+#else
+#  if MM_QUICK
+    if (GET_SIZE(HDRP(ptr)) <= QUICK_MAX_SIZE) { quick_free(ptr); return; } // 작은 블록은 병합을 미룸
+#  endif
+    free_block(ptr);
+#endif
 }
 
 /******************************** API: realloc ********************************/
+#if ALLOC_POLICY != POLICY_BUDDY
+/*
+ * realloc_fit - 할당 블록 bp가 이웃 가용 블록을 흡수해 total 바이트가 됐을 때 asize만 남기고 나머지를 가용으로
+ * (흡수한 블록은 가용 자료구조에서 이미 빠져 있음, bp의 prev-alloc 비트는 호출자가 맞춰 둠)
+ */
+static void realloc_fit(void *bp, size_t total, size_t asize)
+{
+    unsigned prev_bit = GET_PREV_ALLOC(HDRP(bp)); // 블록의 prev-alloc 비트 보존
+    size_t rem = total - asize; // 흡수 후 남는 크기
+
+    if (rem >= MIN_BLOCK) { // 남는 공간이 최소 블록 크기 이상이면 분할
+        PUT(HDRP(bp), PACK(asize, prev_bit | 1)); // 요청 크기로 블록 조정
+        void *split = NEXT_BLKP(bp); // 분할될 블록 위치
+        PUT(HDRP(split), PACK(rem, PREV_ALLOC)); // 남는 부분을 가용 블록으로 설정
+        PUT(FTRP(split), PACK(rem, 0));
+        CLR_PREV_ALLOC(HDRP(NEXT_BLKP(split))); // 그 다음 블록에 앞 블록이 가용됐음을 알림
+        (void)coalesce(split); // 가용 자료구조에 넣음 (뒤의 가용 블록은 이미 흡수돼 병합할 것이 없음)
+    } else {
+        PUT(HDRP(bp), PACK(total, prev_bit | 1)); // 흡수한 블록 전체를 사용
+        SET_PREV_ALLOC(HDRP(NEXT_BLKP(bp))); // 다음 블록에 앞 블록이 할당됐음을 알림
+    }
+    FIT_MOVED(bp, NEXT_BLKP(bp), NEXT_BLKP(bp)); // next-fit: rover가 흡수된 블록 안을 가리키지 않도록
+}
+
+/*
+ * shrink_block - 할당 블록 bp를 asize로 줄이고 남는 부분이 최소 블록 크기 이상이면 가용으로 돌려보냄
+ */
+static void shrink_block(void *bp, size_t asize)
+{
+    size_t excess = GET_SIZE(HDRP(bp)) - asize; // 축소 후 남는 크기
+    if (excess >= MIN_BLOCK) { // 남는 공간이 최소 블록 크기 이상이면 분할
+        PUT(HDRP(bp), PACK(asize, GET_PREV_ALLOC(HDRP(bp)) | 1)); // 축소된 블록의 헤더 설정
+        void *split = NEXT_BLKP(bp); // 분할될 블록의 시작 위치
+        PUT(HDRP(split), PACK(excess, PREV_ALLOC)); // 분할된 가용 블록의 헤더 설정
+        PUT(FTRP(split), PACK(excess, 0)); // 분할된 가용 블록의 푸터 설정
+        CLR_PREV_ALLOC(HDRP(NEXT_BLKP(split))); // 그 다음 블록에 앞 블록이 가용됐음을 알림
+        (void)coalesce(split); // 분할된 블록을 인접 가용 블록과 병합
+    }
+    // 남는 공간이 작으면 내부 단편화 허용하고 분할하지 않음
+}
+#endif
+
+/********************** Realloc growth reservations (MM_GROW) ********************/
+#if MM_GROW
+/*
+ * 문자열 빌더나 벡터처럼 realloc으로 계속 커지는 블록은 커질 때마다 복사하면 전체 비용이 O(n^2)이 된다.
+ * 아레나마다 최근 realloc된 블록을 주소 해시 표(grow_hist)에 기록해 두고,
+ * GROW_AFTER번 연달아 커진 블록에는 요청의 1.5배(GROW_RESERVE)를 잡아 준다.
+ *   - 예약된 여유 안에서 다시 커지면 mm_realloc은 아무것도 하지 않는다 (축소로 보고 떼어 내지 않음).
+ *   - 제자리에서 못 늘려 옮겨야 하면 힙 끝(wilderness) 블록에 놓아 다음 확장이 "힙 끝" 경로로 끝나게 한다.
+ *   - 힙을 더 늘릴 수 없으면 alloc_block이 grow_reclaim으로 모든 예약을 요청 크기로 되돌린다.
+ * 기록은 GROW_MIN 이상 블록만 남기므로 (tcache/슬랩에 들어가지 않음) 해제는 항상 free_block을 거쳐 지워진다.
+ * 줄어든 블록의 기록은 바로 지운다.
+ */
+#  define GROW_SLOT(bp)        (((uintptr_t)(bp) >> 4) & (GROW_HIST - 1))
+
+#  if MM_TCACHE && GROW_MIN <= TCACHE_MAX_SIZE
+#    error "GROW_MIN must be larger than TCACHE_MAX_SIZE (tracked blocks must not be cached)"
+#  endif
+#  if MM_SLAB && GROW_MIN <= SLAB_MAX_OBJ
+#    error "GROW_MIN must be larger than SLAB_MAX_OBJ"
+#  endif
+
+/*
+ * grow_forget - 블록 bp의 확장 기록을 지움 (호출자가 소유 아레나 락을 잡고 있음)
+ */
+static void grow_forget(void *bp)
+{
+    if (arena->grow_hist[GROW_SLOT(bp)].bp == bp)
+        arena->grow_hist[GROW_SLOT(bp)].bp = NULL;
+}
+
+/*
+ * grow_track - 크기 csize인 블록 bp가 asize로 realloc됨을 기록하고, 잡아 줄 블록 크기를 반환
+ * (연달아 커진 블록이면 asize보다 큰 예약 크기). 호출자가 소유 아레나 락을 잡고 있음.
+ */
+static size_t grow_track(void *bp, size_t csize, size_t asize)
+{
+    typeof(arena->grow_hist[0]) *e = &arena->grow_hist[GROW_SLOT(bp)];
+    uint32_t grows;
+
+    if (e->bp == bp) grows = (asize > e->asize) ? e->grows + 1 : 0;
+    else grows = (asize > csize) ? 1 : 0;
+    if (grows == 0 || csize < GROW_MIN) { // 줄었거나 작은 블록: 기록하지 않음
+        if (e->bp == bp) e->bp = NULL;
+        return asize;
+    }
+    e->bp = bp;
+    e->grows = grows;
+    e->asize = (uint32_t)asize;
+    return (grows >= GROW_AFTER) ? GROW_RESERVE(asize) : asize;
+}
+
+/*
+ * grow_rekey - 같은 아레나 안에서 블록이 oldp에서 newp로 옮겨졌을 때 기록을 옮김 (호출자가 아레나 락을 잡고 있음)
+ */
+static void grow_rekey(void *oldp, void *newp)
+{
+    typeof(arena->grow_hist[0]) e = arena->grow_hist[GROW_SLOT(oldp)];
+
+    if (e.bp != oldp) return;
+    arena->grow_hist[GROW_SLOT(oldp)].bp = NULL;
+    e.bp = newp;
+    arena->grow_hist[GROW_SLOT(newp)] = e;
+}
+
+/*
+ * grow_moved - 블록이 새로 할당한 newp로 옮겨졌을 때 확장 횟수를 이어서 기록 (두 아레나의 락을 차례로 잡음)
+ */
+static void grow_moved(void *oldp, void *newp, size_t asize)
+{
+    typeof(arena->grow_hist[0]) *e;
+    uint32_t grows = 1;
+
+    ARENA_ENTER(arena_of(oldp));
+    e = &arena->grow_hist[GROW_SLOT(oldp)];
+    if (e->bp == oldp) grows = e->grows;
+    ARENA_LEAVE();
+
+    ARENA_ENTER(arena_of(newp));
+    e = &arena->grow_hist[GROW_SLOT(newp)];
+    e->bp = newp;
+    e->grows = grows;
+    e->asize = (uint32_t)asize;
+    ARENA_LEAVE();
+}
+
+/*
+ * grow_reclaim - 현재 아레나의 모든 예약을 요청 크기로 되돌림. 회수한 블록이 있으면 1
+ * (호출자가 아레나 락을 잡고 있음)
+ */
+static int grow_reclaim(void)
+{
+    int reclaimed = 0;
+
+    for (int i = 0; i < GROW_HIST; i++) {
+        char *bp = arena->grow_hist[i].bp;
+        size_t size;
+        if (bp == NULL) continue;
+#  if MM_SLAB
+        if (in_slab(bp)) { // 기록은 힙 블록만 남아야 한다 (슬랩 칸은 헤더가 없어 shrink_block이 이웃 칸을 덮어씀)
+            arena->grow_hist[i].bp = NULL;
+            continue;
+        }
+#  endif
+        size = GET_SIZE(HDRP(bp)); // 옮기는 중인 블록은 아직 asize보다 작을 수 있음
+        if (size > arena->grow_hist[i].asize && size - arena->grow_hist[i].asize >= MIN_BLOCK) {
+            shrink_block(bp, arena->grow_hist[i].asize);
+            reclaimed = 1;
+        }
+        arena->grow_hist[i].bp = NULL; // 예약을 돌려줬으니 다시 처음부터 센다
+    }
+    return reclaimed;
+}
+
+/*
+ * alloc_top - 힙 끝(wilderness)에 asize 블록을 할당 (호출자가 아레나 락을 잡고 있음)
+ * 에필로그 앞 가용 블록으로 모자라면 모자란 만큼만 힙을 늘린다.
+ * 아레나 세그먼트가 memlib 힙의 끝이 아니면 NULL.
+ */
+static void *alloc_top(size_t asize)
+{
+    char *end = heap_end(); // 에필로그 다음 주소
+    if (end == NULL) return NULL;
+    size_t tsize = GET_PREV_ALLOC(HDRP(end)) ? 0 : GET_SIZE(HDRP(end) - WSIZE); // 에필로그 앞 가용 블록 (푸터로 크기)
+    char *bp = end - tsize;
+
+    if (tsize < asize) {
+        bp = extend_heap(MAX(asize - tsize, MIN_BLOCK)/WSIZE); // 맨 끝 가용 블록과 병합됨
+        if (bp == NULL || GET_SIZE(HDRP(bp)) < asize) return NULL; // 다른 세그먼트에 생겼으면 그대로 가용으로 둠
+    }
+    place(bp, asize);
+    return bp;
+}
+#endif
+
 /*
  * mm_realloc - 기존 블록의 크기를 변경
  * 가능하면 제자리에서 확장/축소하고, 불가능하면 새로 할당 후 복사한다.
+ * 제자리 확장은 뒤 가용 블록 흡수, 힙 끝이면 모자란 만큼만 힙 확장,
+ * 앞(+뒤) 가용 블록 흡수 후 payload를 앞으로 옮기기 순서로 시도한다.
  */
 void *mm_realloc(void *ptr, size_t size)
 {
@@ -604,63 +2759,466 @@ void *mm_realloc(void *ptr, size_t size)
     if (ptr == NULL) return mm_malloc(size); // NULL 포인터면 새로 할당
     if (size == 0) { mm_free(ptr); return NULL; } // 크기 0이면 해제
 
+#if MM_SLAB
+    if (in_slab(ptr)) { // 슬랩 칸: 칸 안에 들어가면 그대로, 아니면 새로 할당 후 복사
+        size_t osize = slab_obj_size(ptr);
+        if (size <= osize) return ptr;
+        void *newp = mm_malloc(size);
+        if (newp == NULL) return NULL;
+        memcpy(newp, ptr, osize);
+        mm_free(ptr);
+        return newp;
+    }
+#endif
+
+#if MM_MMAP
+    if (IS_MMAPPED(ptr)) {
+        if (size >= MMAP_THRESHOLD) return mmap_realloc(ptr, size); // 여전히 크면 mremap (복사 없음)
+        void *newp = mm_malloc(size); // 작아졌으면 힙으로 옮김 (복사량 < MMAP_THRESHOLD)
+        if (newp == NULL) return NULL;
+        memcpy(newp, ptr, size);
+        mmap_free(ptr);
+        return newp;
+    }
+#endif
+
     // 요청 크기 정렬 및 최소 블록 크기 보장
-    size_t asize = ALIGN(size + DSIZE); // 헤더/푸터 포함하여 8의 배수로 정렬
+    size_t asize = ALIGN(size + WSIZE); // 헤더 포함하여 ALIGNMENT의 배수로 정렬
     if (asize < MIN_BLOCK) asize = MIN_BLOCK; // 정책별 최소 블록 크기 적용
+#if ALLOC_POLICY == POLICY_BUDDY
+    asize = BUDDY_ROUND(asize); // 버디: 2의 거듭제곱으로 올림
+#endif
 
+    ARENA_ENTER(arena_of(ptr)); // 제자리 변경은 블록을 소유한 아레나에서
     size_t csize = GET_SIZE(HDRP(ptr)); // 현재 블록의 크기
 
+#if ALLOC_POLICY == POLICY_BUDDY
+    // 버디: 절반씩 돌려보내며 축소하거나, 위쪽 버디들이 가용이면 흡수해 제자리 확장
+    if (buddy_resize(ptr, asize)) {
+        ARENA_LEAVE();
+        return ptr;
+    }
+#else
+    size_t want = asize; // 잡아 줄 블록 크기 (반복해서 커지는 블록이면 여유 포함)
+#if MM_GROW
+    want = grow_track(ptr, csize, asize);
+#endif
+
     // Case 1: 축소 - 요청 크기가 현재 크기보다 작거나 같음
     if (asize <= csize) {
-        size_t excess = csize - asize; // 축소 후 남는 크기
-        if (excess >= MIN_BLOCK) { // 남는 공간이 최소 블록 크기 이상이면 분할
-            PUT(HDRP(ptr), PACK(asize, 1)); // 축소된 블록의 헤더 설정
-            PUT(FTRP(ptr), PACK(asize, 1)); // 축소된 블록의 푸터 설정
-            void *split = NEXT_BLKP(ptr); // 분할될 블록의 시작 위치
-            PUT(HDRP(split), PACK(excess, 0)); // 분할된 가용 블록의 헤더 설정
-            PUT(FTRP(split), PACK(excess, 0)); // 분할된 가용 블록의 푸터 설정
-            (void)coalesce(split); // 분할된 블록을 인접 가용 블록과 병합
-        }
-        // 남는 공간이 작으면 내부 단편화 허용하고 분할하지 않음
+        if (want == asize) shrink_block(ptr, asize); // 예약된 여유 안에서 커진 것이면 떼어 내지 않음
+        ARENA_LEAVE();
         return ptr; // 기존 포인터 반환
     }
 
-    // Case 2: 확장 시도 - 다음 블록이 가용이면 병합하여 제자리 확장
+    // 이웃 가용 블록 (가용이 아니면 크기 0)
     void *next = NEXT_BLKP(ptr); // 다음 블록 포인터
-    if (!GET_ALLOC(HDRP(next))) { // 다음 블록이 가용 상태라면
-        size_t combined = csize + GET_SIZE(HDRP(next)); // 현재 + 다음 블록의 총 크기
-        if (combined >= asize) { // 병합 후 크기가 요청 크기 이상이면
-#if ALLOC_POLICY == POLICY_EXPLICIT_FF
-            remove_free_block(next); // 명시적: 다음 블록을 가용 리스트에서 제거
-#elif ALLOC_POLICY == POLICY_SEGREGATED_BF
-            remove_segregated_block(next); // 분리: 다음 블록을 해당 클래스 리스트에서 제거
-#endif
-            PUT(HDRP(ptr), PACK(combined, 1)); // 병합된 블록으로 헤더 설정
-            PUT(FTRP(ptr), PACK(combined, 1)); // 병합된 블록으로 푸터 설정
-            
-            // 병합 후에도 남는 공간이 있으면 분할
-            size_t rem = combined - asize; // 병합 후 남는 크기
-            if (rem >= MIN_BLOCK) { // 남는 공간이 최소 블록 크기 이상이면
-                PUT(HDRP(ptr), PACK(asize, 1)); // 요청 크기로 블록 조정
-                PUT(FTRP(ptr), PACK(asize, 1));
-                void *split = NEXT_BLKP(ptr); // 분할될 블록 위치
-                PUT(HDRP(split), PACK(rem, 0)); // 남는 부분을 가용 블록으로 설정
-                PUT(FTRP(split), PACK(rem, 0));
-                (void)coalesce(split); // 분할된 블록 병합
-            }
-            return ptr; /* grown in place - 제자리 확장 성공 */
+    size_t nsize = GET_ALLOC(HDRP(next)) ? 0 : GET_SIZE(HDRP(next));
+
+    // Case 3: 힙 끝 - 블록(과 뒤의 가용 블록)이 에필로그 바로 앞이면 모자란 만큼만 힙을 늘려 다음 가용 블록으로 붙인다
+    char *end = nsize ? NEXT_BLKP(next) : next; // 에필로그라면 그 다음 주소 = 세그먼트 끝
+    if (csize + nsize < asize && GET_SIZE(HDRP(end)) == 0 && heap_top(end)) {
+#if MM_ADAPT_EXTEND
+        // 반복해서 커지는 블록이면 예약분도 함께 늘리되 힙 크기에 비례하는 만큼까지 (여유는 블록 안에 두어 남이 쪼개 쓰지 못하게)
+        HEAP_LOCK();
+        size_t step = (mem_heapsize() >> EXTEND_TOP_SHIFT) & ~(size_t)(ALIGNMENT - 1);
+        HEAP_UNLOCK();
+        size_t shortfall = MAX(asize - csize - nsize + MIN(want - asize, step), MIN_BLOCK);
+#else
+        size_t shortfall = MAX(asize - csize - nsize, MIN_BLOCK); // 힙 끝에서는 언제든 다시 늘릴 수 있으므로 예약하지 않음
+#endif
+        if (extend_heap(shortfall/WSIZE) != NULL) { // 새 가용 블록은 next와 병합됨
+            next = NEXT_BLKP(ptr);
+            nsize = GET_ALLOC(HDRP(next)) ? 0 : GET_SIZE(HDRP(next));
+        }
+    }
+
+    // Case 2: 확장 시도 - 다음 블록이 가용이면 병합하여 제자리 확장
+    if (csize + nsize >= asize) {
+        FREE_REMOVE(next); // 다음 블록을 가용 자료구조에서 제거
+        realloc_fit(ptr, csize + nsize, MIN(want, csize + nsize));
+        ARENA_LEAVE();
+        return ptr; /* grown in place - 제자리 확장 성공 */
+    }
+
+    // Case 4: 앞 블록이 가용이면 앞(+뒤) 블록과 합쳐 payload를 앞으로 옮긴다 (memmove, 새 할당보다 힙을 덜 늘림)
+    if (!GET_PREV_ALLOC(HDRP(ptr))) {
+        void *prev = PREV_BLKP(ptr); // 앞 블록은 가용이라 푸터가 있음
+        size_t psize = GET_SIZE(HDRP(prev));
+        if (psize + csize + nsize >= asize) {
+            FREE_REMOVE(prev);
+            if (nsize) FREE_REMOVE(next);
+            memmove(prev, ptr, csize - WSIZE); // 겹치는 영역이므로 memmove (payload만)
+#if MM_GROW
+            grow_rekey(ptr, prev);
+#endif
+            PUT(HDRP(prev), PACK(psize, PREV_ALLOC | 1)); // 가용 블록 앞은 항상 할당 블록
+            realloc_fit(prev, psize + csize + nsize, MIN(want, psize + csize + nsize));
+            ARENA_LEAVE();
+            return prev;
         }
     }
+#endif
+    ARENA_LEAVE(); // 새 블록 할당/해제는 각자 알맞은 아레나의 락을 잡는다
 
-    // Case 3: 제자리 확장 불가 - 새로 할당 후 데이터 복사
-    void *newp = mm_malloc(size); // 새 블록 할당
+    // Case 5: 제자리 확장 불가 - 새로 할당 후 데이터 복사
+    void *newp = NULL;
+#if MM_GROW
+    if (want > asize) { // 반복해서 커지는 블록: 예약 크기로 힙 끝에 놓아 다음 확장이 제자리에서 끝나게
+#  ifdef MM_THREADS
+        ARENA_ENTER(thread_arena());
+#  endif
+        newp = alloc_top(want);
+        ARENA_LEAVE();
+        if (newp == NULL) newp = mm_malloc(want - WSIZE);
+    }
+#endif
+    if (newp == NULL) newp = mm_malloc(size); // 새 블록 할당
     if (newp == NULL) return NULL; // 할당 실패시 NULL 반환
+#if MM_GROW
+    // grow_track과 같은 조건 (csize >= GROW_MIN이면 size > SLAB_MAX_OBJ라 newp는 슬랩 칸이 아님, 슬랩 칸은 헤더가 없음)
+    if (csize >= GROW_MIN && !IS_MMAPPED(newp))
+        grow_moved(ptr, newp, asize); // 옮겨 간 블록에서도 확장 횟수를 이어서 셈
+#endif
     
-    size_t copySize = csize - DSIZE; /* payload only - 헤더/푸터 제외한 payload 크기 */
+    size_t copySize = csize - WSIZE; /* payload only - 헤더 제외한 payload 크기 */
     if (size < copySize) copySize = size; // 복사할 크기는 요청 크기와 기존 payload 중 작은 값
     memcpy(newp, ptr, copySize); // 기존 데이터를 새 블록으로 복사
     mm_free(ptr); // 기존 블록 해제
     return newp; // 새 블록 포인터 반환
 }
 
+/******************************** API: calloc *********************************/
+/*
+ * 힙은 0으로 채워진 채 시작하므로 (memlib), 한 번도 내준 적 없는 힙(mem_heap_fresh 위)은 지울 필요가 없다.
+ * CALLOC_FRESH_MIN 이상인 요청은 아레나 락을 잡은 채 그 경계를 읽고 할당해서
+ *   - 경계 아래(재사용된 메모리)만 memset으로 지우고,
+ *   - 경계 위(이번 할당에서 mem_sbrk로 새로 얻은 메모리)는 할당기가 직접 쓴 자리만 지운다:
+ *     가용 블록이었을 때 payload 앞의 링크/트리 노드(CALLOC_META)와 끝의 푸터.
+ * 더 작은 요청은 슬랩/quick list 빠른 경로를 그대로 타고 전부 memset한다 (지울 양이 작음).
+ * mmap 블록은 새 매핑이라 이미 0이다. 버디는 힙 끝을 조각으로 늘려 병합하므로 조각 헤더가
+ * 블록 안에 남아 항상 전부 지운다.
+ */
+#ifndef CALLOC_FRESH_MIN
+#  define CALLOC_FRESH_MIN     CHUNKSIZE // 새 메모리 여부를 따질 최소 요청 크기 (바이트)
+#endif
+#define CALLOC_META            (4 * sizeof(void *)) // 가용 블록 payload 앞에 할당기가 쓰는 최대 바이트 (링크/트리 노드)
+
+/*
+ * mm_calloc - nmemb * size 바이트를 0으로 채워 할당 (곱이 넘치면 NULL, errno = ENOMEM)
+ */
+void *mm_calloc(size_t nmemb, size_t size)
+{
+    if (size != 0 && nmemb > SIZE_MAX / size) { errno = ENOMEM; return NULL; } // nmemb * size가 넘침
+    size_t bytes = nmemb * size;
+
+#if ALLOC_POLICY != POLICY_BUDDY
+#  if MM_MMAP
+    if (bytes >= CALLOC_FRESH_MIN && bytes < MMAP_THRESHOLD) {
+#  else
+    if (bytes >= CALLOC_FRESH_MIN) {
+#  endif
+        size_t asize = ALIGN(bytes + WSIZE); // 헤더 포함하여 ALIGNMENT의 배수로 정렬 (MIN_BLOCK보다 큼)
+        ARENA_ENTER(thread_arena()); // 락을 잡은 동안에는 아무도 이 아레나의 새 메모리에 쓰지 않는다
+        HEAP_LOCK();
+        char *fresh = mem_heap_fresh(); // 이번 할당 전까지 한 번도 내준 적 없는 힙의 시작
+        HEAP_UNLOCK();
+        char *bp = alloc_block(asize);
+        ARENA_LEAVE();
+        if (bp == NULL) return NULL;
+
+        char *end = bp + bytes;
+        char *lo = MIN(end, MAX(fresh, bp + CALLOC_META)); // 재사용된 부분 + payload 앞 링크/트리 노드 자리
+        memset(bp, 0, lo - bp);
+        char *ftr = MAX(lo, bp + GET_SIZE(HDRP(bp)) - DSIZE); // 분할되지 않았으면 가용 블록의 푸터 자리
+        if (ftr < end) memset(ftr, 0, end - ftr);
+        return bp;
+    }
+#endif
+
+    void *p = mm_malloc(bytes);
+    if (p == NULL) return NULL;
+#if MM_MMAP
+    if (bytes >= MMAP_THRESHOLD && IS_MMAPPED(p)) return p; // 새 매핑은 이미 0 (슬랩 칸은 헤더가 없어 크기로 먼저 거름)
+#endif
+    memset(p, 0, bytes);
+    return p;
+}
+
+/********************************* API: batch *********************************/
+/*
+ * 같은 크기 N개를 한 번에 할당하고, 포인터 N개를 한 번에 해제한다.
+ *   - mm_malloc_batch는 N개 몫(k * asize)을 find_fit + place 한 번으로 잡아 연속한 블록 k개로 나눈다.
+ *     한 덩어리는 BATCH_RUN_MAX 바이트까지만 잡고 (큰 가용 블록 하나를 통째로 쪼개거나 힙을 한꺼번에 늘리지 않음),
+ *     못 잡으면 덩어리를 반으로 줄여 다시 시도한다.
+ *   - mm_free_batch는 포인터를 주소순으로 정렬한 뒤 힙에서 바로 이어진 블록들을 (BATCH_RUN_MAX 미만까지)
+ *     한 블록으로 묶어 free_block(coalesce)을 한 번만 부른다. 낱개, 슬랩 칸, mmap 블록은 mm_free로 보낸다.
+ * 슬랩/mmap 크기의 요청은 각자의 할당기로 하나씩 받고, 버디는 블록을 2^k 단위로만 나눌 수 있어 하나씩 할당한다.
+ */
+#ifndef BATCH_RUN_MAX
+#  define BATCH_RUN_MAX        (16 * CHUNKSIZE) // 한 번에 잡아 나눌 최대 바이트
+#endif
+
+/*
+ * mm_malloc_batch - size 바이트 블록을 n개 할당해 ptrs[0..]에 채움. 할당한 개수를 반환 (모자라면 n보다 작음)
+ */
+size_t mm_malloc_batch(size_t size, void **ptrs, size_t n)
+{
+    size_t done = 0;
+
+    if (size == 0) return 0;
+
+#if MM_MMAP
+    if (size >= MMAP_THRESHOLD) { // 큰 요청은 어차피 매핑 하나씩
+        while (done < n && (ptrs[done] = mm_malloc(size)) != NULL) done++;
+        return done;
+    }
+#endif
+
+#if MM_SLAB
+    if (size <= SLAB_MAX_OBJ) { // 작은 요청은 락 한 번에 슬랩 칸으로
+        ARENA_ENTER(thread_arena());
+        while (done < n && (ptrs[done] = slab_alloc(size)) != NULL) done++;
+        ARENA_LEAVE();
+        if (done == n) return done; // 슬랩을 만들 수 없으면 나머지는 일반 블록으로
+    }
+#endif
+
+    size_t asize = ALIGN(size + WSIZE); // mm_malloc과 같은 블록 크기
+    if (asize < MIN_BLOCK) asize = MIN_BLOCK;
+
+    ARENA_ENTER(thread_arena());
+#if ALLOC_POLICY == POLICY_BUDDY
+    asize = BUDDY_ROUND(asize);
+    while (done < n && (ptrs[done] = alloc_block(asize)) != NULL) done++;
+#else
+    size_t k = MAX(BATCH_RUN_MAX / asize, 1);
+    while (done < n) {
+        k = MIN(k, n - done);
+        char *bp = alloc_block(k * asize); // k개 몫의 연속 블록 (남는 부분은 place가 떼어 냄)
+        if (bp == NULL) {
+            if (k == 1) break; // 한 개도 못 잡음
+            k /= 2;
+            continue;
+        }
+        size_t csize = GET_SIZE(HDRP(bp)); // 떼어 내기엔 작은 자투리는 마지막 블록에 붙는다
+        unsigned prev = GET_PREV_ALLOC(HDRP(bp));
+        for (size_t i = 0; i < k; i++, bp += asize) {
+            size_t bsize = (i == k - 1) ? csize - i * asize : asize;
+            PUT(HDRP(bp), PACK(bsize, prev | 1)); // 할당 블록 헤더 (푸터 없음)
+            prev = PREV_ALLOC;
+            ptrs[done++] = bp;
+        }
+#  if MM_ADAPT_EXTEND
+        arena->nallocs += k - 1; // 확장 단위 조절용 할당 속도는 블록 수로 센다
+#  endif
+    }
+#endif
+    ARENA_LEAVE();
+    return done;
+}
+
+/*
+ * ptr_cmp - qsort용 포인터 주소 비교
+ */
+static int ptr_cmp(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)*(void *const *)a, y = (uintptr_t)*(void *const *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * mm_free_batch - ptrs[0..n-1]을 모두 해제 (NULL은 무시). ptrs 배열은 주소순으로 재배열된다.
+ */
+void mm_free_batch(void **ptrs, size_t n)
+{
+    size_t i = 0;
+
+    qsort(ptrs, n, sizeof(void *), ptr_cmp);
+    while (i < n) {
+        char *bp = ptrs[i];
+        size_t j = i + 1;
+#if ALLOC_POLICY != POLICY_BUDDY
+        int heap_block = (bp != NULL);
+#  if MM_SLAB
+        heap_block = heap_block && !in_slab(bp);
+#  endif
+#  if MM_MMAP
+        heap_block = heap_block && !IS_MMAPPED(bp);
+#  endif
+        char *end = bp;
+        // 바로 뒤 블록도 이번에 해제되면 한 블록으로 묶는다 (슬랩 칸/매핑 payload는 블록 경계와 겹치지 않음).
+        // 묶음은 BATCH_RUN_MAX 미만으로 끊어, 작은 블록들을 낱개로 해제할 때는 없던 페이지 반납을 일으키지 않는다.
+        if (heap_block)
+            for (end = NEXT_BLKP(bp); j < n && ptrs[j] == end && NEXT_BLKP(end) - bp < BATCH_RUN_MAX; j++)
+                end = NEXT_BLKP(end);
+
+        if (j - i > 1) {
+            ARENA_ENTER(arena_of(bp)); // 이어진 블록은 같은 세그먼트, 즉 같은 아레나 소유
+#  if MM_GROW
+            for (size_t m = i + 1; m < j; m++) // 첫 블록의 기록은 free_block이 지움
+                if (GET_SIZE(HDRP(ptrs[m])) >= GROW_MIN) grow_forget(ptrs[m]);
+#  endif
+            PUT(HDRP(bp), PACK(end - bp, GET_PREV_ALLOC(HDRP(bp)) | 1)); // 묶은 전체를 한 할당 블록으로
+            free_block(bp); // 병합은 양 끝에서 한 번만
+            ARENA_LEAVE();
+            i = j;
+            continue;
+        }
+#endif
+        mm_free(bp);
+        i = j;
+    }
+}
+
+/****************************** API: usable size ******************************/
+/*
+ * place는 남는 부분이 MIN_BLOCK보다 작으면 블록을 쪼개지 않고 통째로 내주므로, 블록은 요청보다 클 수 있다.
+ * mm_usable_size는 그 실제 payload 크기를 알려 주고, mm_try_expand는 블록을 옮기지 않고
+ * realloc의 제자리 확장 경로(뒤 가용 블록 흡수, 힙 끝이면 힙 확장)만으로 늘려 본다.
+ * 벡터/문자열처럼 커지는 버퍼는 이 둘로 realloc의 복사를 대부분 피할 수 있다.
+ * 할당 블록에는 푸터가 없으므로 payload는 블록 크기 - 헤더(WSIZE)까지다.
+ */
+
+/*
+ * usable_size - 할당된 ptr의 payload 크기 (슬랩 칸, mmap 블록, 힙 블록)
+ */
+static size_t usable_size(void *ptr)
+{
+#if MM_SLAB
+    if (in_slab(ptr)) return slab_obj_size(ptr);
+#endif
+#if MM_MMAP
+    if (IS_MMAPPED(ptr)) return GET_SIZE(HDRP(ptr)) - MMAP_OFFSET; // 매핑 길이 - (패딩 + 헤더)
+#endif
+    return GET_SIZE(HDRP(ptr)) - WSIZE;
+}
+
+/*
+ * mm_usable_size - ptr 블록에 실제로 쓸 수 있는 바이트 수 (요청 크기 이상, NULL이면 0)
+ * 할당된 블록의 크기는 해제나 realloc 전까지 바뀌지 않으므로 락 없이 읽는다.
+ */
+size_t mm_usable_size(void *ptr)
+{
+    if (ptr == NULL) return 0;
+    return usable_size(ptr);
+}
+
+/*
+ * mm_try_expand - ptr 블록을 옮기지 않고 payload가 min 바이트 이상이 되도록 늘림 (가능하면 max 바이트까지)
+ * 늘린 뒤의 usable size를 반환한다. min만큼 늘릴 수 없으면 블록을 그대로 두고 현재 usable size를 반환하므로
+ * 호출자는 반환값 >= min으로 성공을 확인한다. 블록을 줄이지는 않는다.
+ * 슬랩 칸과 mmap 블록은 늘리지 않는다 (칸 크기와 매핑 길이가 고정). 버디는 위쪽 버디가 가용일 때만
+ * 2의 거듭제곱 단위로 늘어난다.
+ */
+size_t mm_try_expand(void *ptr, size_t min, size_t max)
+{
+    if (ptr == NULL) return 0;
+#if MM_SLAB
+    if (in_slab(ptr)) return slab_obj_size(ptr);
+#endif
+#if MM_MMAP
+    if (IS_MMAPPED(ptr)) return usable_size(ptr);
+#endif
+    if (max < min) max = min;
+    if (min > UINT32_MAX - 2*MIN_BLOCK) return usable_size(ptr); // 헤더 size 필드(32비트)를 넘음
+    max = MIN(max, UINT32_MAX - 2*MIN_BLOCK);
+
+    size_t amin = ALIGN(min + WSIZE); // mm_malloc과 같은 블록 크기
+    size_t amax = ALIGN(max + WSIZE);
+
+    ARENA_ENTER(arena_of(ptr)); // 제자리 변경은 블록을 소유한 아레나에서
+    size_t csize = GET_SIZE(HDRP(ptr));
+    if (amin > csize) {
+#if ALLOC_POLICY == POLICY_BUDDY
+        // 버디: 위쪽 버디들이 가용이면 흡수 (max 크기부터, 안 되면 min 크기로)
+        if (!buddy_resize(ptr, BUDDY_ROUND(amax)))
+            (void)buddy_resize(ptr, BUDDY_ROUND(amin));
+#else
+        void *next = NEXT_BLKP(ptr);
+        size_t nsize = GET_ALLOC(HDRP(next)) ? 0 : GET_SIZE(HDRP(next));
+
+        // 힙 끝이면 max까지 (힙에 남은 만큼까지, 실패하면 min까지) 모자란 만큼 힙을 늘려 다음 가용 블록으로 붙인다
+        char *end = nsize ? NEXT_BLKP(next) : next;
+        if (csize + nsize < amin && GET_SIZE(HDRP(end)) == 0 && heap_top(end)) {
+            HEAP_LOCK();
+            size_t room = MIN(mem_heap_room(), INT_MAX) & ~(size_t)(ALIGNMENT - 1); // mem_sbrk(int)가 실패할 요청은 하지 않음
+            HEAP_UNLOCK();
+            size_t need = MAX(amin - csize - nsize, MIN_BLOCK);
+            if (need <= room &&
+                (extend_heap(MIN(MAX(amax - csize - nsize, MIN_BLOCK), room)/WSIZE) != NULL ||
+                 extend_heap(need/WSIZE) != NULL)) {
+                next = NEXT_BLKP(ptr); // 새 가용 블록은 next와 병합됨
+                nsize = GET_ALLOC(HDRP(next)) ? 0 : GET_SIZE(HDRP(next));
+            }
+        }
+
+        if (csize + nsize >= amin) { // 뒤 가용 블록을 흡수하고 max를 넘는 부분은 다시 가용으로
+            FREE_REMOVE(next);
+            realloc_fit(ptr, csize + nsize, MIN(amax, csize + nsize));
+        }
+#endif
+    }
+    size_t usable = usable_size(ptr);
+    ARENA_LEAVE();
+    return usable;
+}
+
+/******************************* API: memalign ********************************/
+/*
+ * mm_memalign - payload 주소가 alignment(2의 거듭제곱)의 배수인 size 바이트 블록 할당
+ * 가용 블록에서 정렬 지점을 잘라 내고 앞뒤 자투리는 가용 블록으로 돌려보내므로 (alloc_aligned_block)
+ * 결과는 보통 블록과 같아 mm_free/mm_realloc에 그대로 넘길 수 있다 (realloc으로 옮기면 정렬은 보장 안 됨).
+ * 슬랩 칸과 mmap 블록은 payload 위치가 고정이므로, 기본 정렬보다 큰 요청은 항상 힙 블록으로 받는다.
+ * alignment가 2의 거듭제곱이 아니면 NULL (errno = EINVAL).
+ * 버디는 payload 정렬이 원점 정렬(BUDDY_ORIGIN_ALIGN = 4KB)을 넘지 못하므로 그보다 큰 정렬은 NULL (errno = ENOMEM).
+ */
+void *mm_memalign(size_t alignment, size_t size)
+{
+    if (alignment == 0 || (alignment & (alignment - 1))) { errno = EINVAL; return NULL; }
+    if (alignment <= ALIGNMENT) return mm_malloc(size); // 기본 정렬이면 보통 할당
+    if (size == 0) return NULL; // mm_malloc과 같이 0 바이트 요청은 NULL
+    if (alignment > UINT32_MAX - 2*MIN_BLOCK || size > UINT32_MAX - alignment - 2*MIN_BLOCK) { // 헤더 size 필드(32비트)를 넘음
+        errno = ENOMEM; // alignment를 먼저 걸러야 아래 뺄셈이 넘치지 않는다
+        return NULL;
+    }
+
+    size_t asize = ALIGN(size + WSIZE); // 헤더 포함하여 ALIGNMENT의 배수로 정렬
+    if (asize < MIN_BLOCK) asize = MIN_BLOCK; // 정책별 최소 블록 크기 적용
+#if ALLOC_POLICY == POLICY_BUDDY
+    asize = BUDDY_ROUND(asize); // 버디: 2의 거듭제곱으로 올림
+#endif
+
+    ARENA_ENTER(thread_arena()); // 이 스레드의 아레나에서 할당
+    void *bp = alloc_aligned_block(asize, alignment);
+    ARENA_LEAVE();
+    if (bp == NULL) errno = ENOMEM;
+    return bp;
+}
+
+/*
+ * mm_aligned_alloc - C11 aligned_alloc: mm_memalign과 같다 (size가 alignment의 배수일 필요는 없음)
+ */
+void *mm_aligned_alloc(size_t alignment, size_t size)
+{
+    return mm_memalign(alignment, size);
+}
+
+/*
+ * mm_posix_memalign - POSIX posix_memalign: 성공하면 *memptr에 블록을 두고 0,
+ * alignment가 sizeof(void *)의 배수인 2의 거듭제곱이 아니면 EINVAL, 메모리가 없으면 ENOMEM (*memptr는 그대로)
+ */
+int mm_posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1))) return EINVAL;
+    if (size == 0) { *memptr = NULL; return 0; } // 0 바이트는 NULL로 성공 (mm_free에 넘겨도 됨)
+
+    int saved = errno; // posix_memalign은 errno를 바꾸지 않는다
+    void *p = mm_memalign(alignment, size);
+    errno = saved;
+    if (p == NULL) return ENOMEM;
+    *memptr = p;
+    return 0;
+}
+
 /****************************** End of mm.c ***********************************/
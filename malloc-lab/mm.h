@@ -4,6 +4,30 @@ extern int mm_init (void);
 extern void *mm_malloc (size_t size);
 extern void mm_free (void *ptr);
 extern void *mm_realloc(void *ptr, size_t size);
+extern void *mm_calloc(size_t nmemb, size_t size);
+
+/* Batch calls: mm_malloc_batch returns how many of the n blocks it got;
+   mm_free_batch sorts ptrs by address before freeing them */
+extern size_t mm_malloc_batch(size_t size, void **ptrs, size_t n);
+extern void mm_free_batch(void **ptrs, size_t n);
+
+/* Usable payload bytes of a block, and in-place growth that never moves it:
+   mm_try_expand returns the new usable size (>= min on success) */
+extern size_t mm_usable_size(void *ptr);
+extern size_t mm_try_expand(void *ptr, size_t min, size_t max);
+
+/* Aligned allocation: alignment must be a power of two; free with mm_free */
+extern void *mm_memalign(size_t alignment, size_t size);
+extern void *mm_aligned_alloc(size_t alignment, size_t size);
+extern int mm_posix_memalign(void **memptr, size_t alignment, size_t size);
+
+/* MM_DECAY builds only: background purge worker counters and shutdown */
+extern void mm_decay_stats(size_t *purged, size_t *refaulted);
+extern void mm_decay_shutdown(void);
+
+/* mdriver-all builds only (mmpolicy.c): choose one of the compiled-in policies */
+extern int mm_policy_select(const char *name);
+extern const char *const *mm_policy_names(void);
 
 
 /* 
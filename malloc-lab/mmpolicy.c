@@ -0,0 +1,185 @@
+/*
+ * mmpolicy.c - Run-time selection among the mm.c allocation policies
+ *
+ * "make mdriver-all" compiles mm.c once per policy with
+ * -DALLOC_POLICY=... -DMM_PREFIX=<name>, which renames its public
+ * functions to <name>_mm_init, <name>_mm_malloc, ... . This file collects
+ * them in a dispatch table and provides the usual mm_* entry points,
+ * which forward to the selected policy.
+ *
+ * A policy is chosen with mm_policy_select() before mm_init. If none was
+ * chosen, the first mm_init reads the MM_POLICY environment variable
+ * (default explicit_ff). Switching policies starts over on a fresh heap:
+ * the caller must reset the brk (mem_reset_brk) before the next mm_init,
+ * as mdriver does before every trace.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mm.h"
+
+#ifdef MM_THREADS
+#error "mdriver-all includes the implicit and buddy policies, which do not support MM_THREADS"
+#endif
+
+#define MM_POLICY_DEFAULT "explicit_ff"
+
+/*
+ * The compiled-in policies. Each name must match an MM_PREFIX build of
+ * mm.c (POLICIES in the Makefile) with ALLOC_POLICY=POLICY_<NAME>.
+ */
+#define POLICY_LIST(X) \
+	X(implicit_ff)     \
+	X(implicit_nf)     \
+	X(explicit_ff)     \
+	X(segregated_bf)   \
+	X(tlsf)            \
+	X(tree_bf)         \
+	X(buddy)           \
+	X(address_ff)
+
+/* Prototypes of <name>_mm_init ... from the MM_PREFIX builds */
+#define DECLARE(name)                            \
+	extern int name##_mm_init(void);             \
+	extern void *name##_mm_malloc(size_t size);  \
+	extern void name##_mm_free(void *ptr);       \
+	extern void *name##_mm_realloc(void *ptr, size_t size); \
+	extern void *name##_mm_calloc(size_t nmemb, size_t size); \
+	extern size_t name##_mm_malloc_batch(size_t size, void **ptrs, size_t n); \
+	extern void name##_mm_free_batch(void **ptrs, size_t n); \
+	extern size_t name##_mm_usable_size(void *ptr); \
+	extern size_t name##_mm_try_expand(void *ptr, size_t min, size_t max); \
+	extern void *name##_mm_memalign(size_t alignment, size_t size); \
+	extern void *name##_mm_aligned_alloc(size_t alignment, size_t size); \
+	extern int name##_mm_posix_memalign(void **memptr, size_t alignment, size_t size);
+POLICY_LIST(DECLARE)
+
+typedef struct
+{
+	const char *name;
+	int (*init)(void);
+	void *(*malloc)(size_t size);
+	void (*free)(void *ptr);
+	void *(*realloc)(void *ptr, size_t size);
+	void *(*calloc)(size_t nmemb, size_t size);
+	size_t (*malloc_batch)(size_t size, void **ptrs, size_t n);
+	void (*free_batch)(void **ptrs, size_t n);
+	size_t (*usable_size)(void *ptr);
+	size_t (*try_expand)(void *ptr, size_t min, size_t max);
+	void *(*memalign)(size_t alignment, size_t size);
+	void *(*aligned_alloc)(size_t alignment, size_t size);
+	int (*posix_memalign)(void **memptr, size_t alignment, size_t size);
+} mm_policy_t;
+
+#define ENTRY(name) {#name, name##_mm_init, name##_mm_malloc, name##_mm_free, name##_mm_realloc, \
+					 name##_mm_calloc, name##_mm_malloc_batch, name##_mm_free_batch, \
+					 name##_mm_usable_size, name##_mm_try_expand, \
+					 name##_mm_memalign, name##_mm_aligned_alloc, name##_mm_posix_memalign},
+static const mm_policy_t policies[] = {POLICY_LIST(ENTRY)};
+#define NPOLICIES (sizeof(policies) / sizeof(policies[0]))
+
+#define NAME(name) #name,
+static const char *const names[] = {POLICY_LIST(NAME) NULL};
+
+static const mm_policy_t *policy; /* selected policy (NULL until selected) */
+
+/*
+ * mm_policy_select - make the policy called name current. Returns 0, or
+ *     -1 if no such policy was compiled in.
+ */
+int mm_policy_select(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < NPOLICIES; i++)
+		if (!strcmp(policies[i].name, name))
+		{
+			policy = &policies[i];
+			return 0;
+		}
+	return -1;
+}
+
+/*
+ * mm_policy_names - NULL-terminated list of the compiled-in policy names
+ */
+const char *const *mm_policy_names(void)
+{
+	return names;
+}
+
+/*
+ * mm_init - initialize the selected policy, picking one from the
+ *     MM_POLICY environment variable first if none was selected
+ */
+int mm_init(void)
+{
+	if (policy == NULL)
+	{
+		const char *name = getenv("MM_POLICY");
+		if (name == NULL || *name == '\0')
+			name = MM_POLICY_DEFAULT;
+		if (mm_policy_select(name) < 0)
+		{
+			fprintf(stderr, "mm_init: unknown MM_POLICY \"%s\"\n", name);
+			return -1;
+		}
+	}
+	return policy->init();
+}
+
+void *mm_malloc(size_t size)
+{
+	return policy->malloc(size);
+}
+
+void mm_free(void *ptr)
+{
+	policy->free(ptr);
+}
+
+void *mm_realloc(void *ptr, size_t size)
+{
+	return policy->realloc(ptr, size);
+}
+
+void *mm_calloc(size_t nmemb, size_t size)
+{
+	return policy->calloc(nmemb, size);
+}
+
+size_t mm_malloc_batch(size_t size, void **ptrs, size_t n)
+{
+	return policy->malloc_batch(size, ptrs, n);
+}
+
+void mm_free_batch(void **ptrs, size_t n)
+{
+	policy->free_batch(ptrs, n);
+}
+
+size_t mm_usable_size(void *ptr)
+{
+	return policy->usable_size(ptr);
+}
+
+size_t mm_try_expand(void *ptr, size_t min, size_t max)
+{
+	return policy->try_expand(ptr, min, max);
+}
+
+void *mm_memalign(size_t alignment, size_t size)
+{
+	return policy->memalign(alignment, size);
+}
+
+void *mm_aligned_alloc(size_t alignment, size_t size)
+{
+	return policy->aligned_alloc(alignment, size);
+}
+
+int mm_posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+	return policy->posix_memalign(memptr, alignment, size);
+}
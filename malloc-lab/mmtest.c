@@ -0,0 +1,367 @@
+/*
+ * mmtest.c - Checks for the mm.c entry points that mdriver does not drive
+ *
+ * mdriver replays malloc/free/realloc traces only. This program exercises
+ * the rest of the public API against one build of mm.c:
+ *   - mm_memalign / mm_aligned_alloc / mm_posix_memalign
+ *   - mm_calloc
+ *   - mm_malloc_batch / mm_free_batch
+ *   - mm_usable_size / mm_try_expand
+ *   - mm_realloc from a small heap block into a slab slot, followed by
+ *     running the heap out of memory (memlib reports the failed sbrk)
+ *
+ * Every block handed out is filled to its usable size and re-checked
+ * before it is freed, so a block that overlaps a neighbour shows up as a
+ * corrupted pattern. "make test" builds and runs it for every policy and
+ * for the MM_THREADS and ALIGNMENT=16 variants.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "mm.h"
+#include "memlib.h"
+#include "config.h"
+
+#define NBATCH 64 /* blocks per mm_malloc_batch call */
+#define NHOLD 4096 /* blocks held while running the heap out of memory */
+#define HOLD_SIZE 60000 /* their size (below the mmap threshold) */
+
+static int nchecks, nfailed;
+
+/* CHECK - count a check and report it (with the line) if cond is false */
+#define CHECK(cond)                                                        \
+	do {                                                                   \
+		nchecks++;                                                         \
+		if (!(cond)) {                                                     \
+			nfailed++;                                                     \
+			fprintf(stderr, "mmtest.c:%d: check failed: %s\n", __LINE__, #cond); \
+		}                                                                  \
+	} while (0)
+
+/*
+ * fill - write a pattern derived from tag over the whole usable size of p
+ */
+static void fill(void *p, unsigned char tag)
+{
+	memset(p, tag, mm_usable_size(p));
+}
+
+/*
+ * intact - 1 if the first n bytes of p all hold tag
+ */
+static int intact(const void *p, size_t n, unsigned char tag)
+{
+	const unsigned char *q = p;
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		if (q[i] != tag)
+			return 0;
+	return 1;
+}
+
+/*
+ * test_memalign - results are aligned, usable and independent; bad
+ *     alignments are rejected with EINVAL
+ */
+static void test_memalign(void)
+{
+	static const size_t sizes[] = {1, 24, 100, 1000, 5000};
+	void *blocks[64];
+	size_t nb = 0, a, i;
+	void *p;
+	int rc;
+
+	/* Alignments that cannot fit a 32-bit block size fail cleanly (first, on the fresh heap) */
+	errno = 0;
+	CHECK(mm_memalign((size_t)1 << 32, 8000) == NULL && errno == ENOMEM);
+	errno = 0;
+	CHECK(mm_aligned_alloc((size_t)1 << 32, 8000) == NULL && errno == ENOMEM);
+	errno = 0;
+	CHECK(mm_memalign((size_t)1 << 33, 100) == NULL && errno == ENOMEM);
+	CHECK(mm_posix_memalign(&p, (size_t)1 << 32, 8000) == ENOMEM);
+
+	for (a = 2 * ALIGNMENT; a <= 4096; a <<= 1) {
+		for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+			p = mm_memalign(a, sizes[i]);
+			CHECK(p != NULL);
+			if (p == NULL)
+				continue;
+			CHECK((uintptr_t)p % a == 0);
+			CHECK(mm_usable_size(p) >= sizes[i]);
+			fill(p, (unsigned char)nb);
+			blocks[nb++] = p;
+		}
+	}
+	/* Larger alignments may fail with ENOMEM (buddy), but never misalign */
+	errno = 0;
+	p = mm_memalign(1 << 16, 100);
+	CHECK(p != NULL ? (uintptr_t)p % (1 << 16) == 0 : errno == ENOMEM);
+	mm_free(p);
+
+	p = mm_aligned_alloc(64, 200);
+	CHECK(p != NULL && (uintptr_t)p % 64 == 0);
+	mm_free(p);
+
+	/* Alignments up to ALIGNMENT are plain mallocs */
+	p = mm_memalign(ALIGNMENT, 10);
+	CHECK(p != NULL && (uintptr_t)p % ALIGNMENT == 0);
+	mm_free(p);
+
+	errno = 0;
+	CHECK(mm_memalign(48, 10) == NULL && errno == EINVAL);
+
+	p = (void *)1;
+	CHECK(mm_posix_memalign(&p, 3 * sizeof(void *), 10) == EINVAL);
+	CHECK(mm_posix_memalign(&p, sizeof(void *) / 2, 10) == EINVAL);
+	CHECK(p == (void *)1); /* untouched on error */
+	errno = 0;
+	rc = mm_posix_memalign(&p, 256, 3000);
+	CHECK(rc == 0 && p != NULL && (uintptr_t)p % 256 == 0);
+	CHECK(errno == 0);
+	if (rc == 0)
+		mm_free(p);
+
+	for (i = 0; i < nb; i++) {
+		CHECK(intact(blocks[i], mm_usable_size(blocks[i]), (unsigned char)i));
+		mm_free(blocks[i]);
+	}
+}
+
+/*
+ * test_calloc - memory is zeroed, also when it reuses freed (dirty)
+ *     blocks; nmemb * size overflow fails with ENOMEM
+ */
+static void test_calloc(void)
+{
+	static const size_t sizes[] = {1, 100, 1000, 5000, 20000, 100000, 300000};
+	const size_t n = sizeof(sizes) / sizeof(sizes[0]);
+	void *p[sizeof(sizes) / sizeof(sizes[0])];
+	size_t i;
+	int round;
+
+	for (round = 0; round < 2; round++) { /* round 1 reuses round 0's dirty blocks */
+		for (i = 0; i < n; i++) {
+			p[i] = mm_calloc(1, sizes[i]);
+			CHECK(p[i] != NULL);
+			if (p[i] == NULL)
+				continue;
+			CHECK(intact(p[i], sizes[i], 0));
+			fill(p[i], 0xa5);
+		}
+		for (i = 0; i < n; i++)
+			mm_free(p[i]);
+	}
+
+	p[0] = mm_calloc(25, 40);
+	CHECK(p[0] != NULL && intact(p[0], 1000, 0));
+	mm_free(p[0]);
+
+	errno = 0;
+	CHECK(mm_calloc(SIZE_MAX / 2 + 1, 2) == NULL && errno == ENOMEM);
+	errno = 0;
+	CHECK(mm_calloc(2, SIZE_MAX / 2 + 1) == NULL && errno == ENOMEM);
+}
+
+/*
+ * test_batch - mm_malloc_batch blocks are distinct and usable, and
+ *     mm_free_batch (unsorted, with NULLs) gives them all back
+ */
+static void test_batch(void)
+{
+	static const size_t sizes[] = {1, 24, 100, 300, 1000, 5000, 200000};
+	void *ptrs[NBATCH], *again[NBATCH];
+	size_t i, j, k, got;
+	int ok;
+
+	CHECK(mm_malloc_batch(0, ptrs, NBATCH) == 0);
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		got = mm_malloc_batch(sizes[i], ptrs, NBATCH);
+		CHECK(got == NBATCH);
+		for (j = 0; j < got; j++) {
+			CHECK((uintptr_t)ptrs[j] % ALIGNMENT == 0);
+			CHECK(mm_usable_size(ptrs[j]) >= sizes[i]);
+			fill(ptrs[j], (unsigned char)(j + 1));
+		}
+		for (ok = 1, j = 0; j < got; j++)
+			ok &= intact(ptrs[j], mm_usable_size(ptrs[j]), (unsigned char)(j + 1));
+		CHECK(ok);
+
+		/* Free every other block in reverse order, with NULLs mixed in */
+		for (k = 0, j = got; j-- > 0;) {
+			if (j % 2 == 0) {
+				again[k++] = ptrs[j];
+				ptrs[j] = NULL;
+			} else if (j % 7 == 0)
+				again[k++] = NULL;
+		}
+		mm_free_batch(again, k);
+		for (ok = 1, j = 1; j < got; j += 2)
+			ok &= intact(ptrs[j], mm_usable_size(ptrs[j]), (unsigned char)(j + 1));
+		CHECK(ok);
+		mm_free_batch(ptrs, got); /* the rest, NULL holes included */
+
+		/* The freed space is reusable */
+		got = mm_malloc_batch(sizes[i], ptrs, NBATCH);
+		CHECK(got == NBATCH);
+		mm_free_batch(ptrs, got);
+	}
+}
+
+/*
+ * test_usable_expand - mm_usable_size covers the request; mm_try_expand
+ *     never moves or shrinks a block, reaches min on success and keeps
+ *     the contents
+ */
+static void test_usable_expand(void)
+{
+	size_t size, us, got, min, max;
+	void *p, *q, *guard;
+	int grown = 0;
+
+	CHECK(mm_usable_size(NULL) == 0);
+	CHECK(mm_try_expand(NULL, 1, 2) == 0);
+
+	for (size = 1; size < 300000; size = size * 3 + 1) {
+		p = mm_malloc(size);
+		CHECK(p != NULL && mm_usable_size(p) >= size);
+		mm_free(p);
+	}
+
+	for (size = 100; size <= 20000; size *= 2) {
+		q = mm_malloc(2 * size); /* p is carved from q's space, so it has room to grow into */
+		guard = mm_malloc(size);
+		mm_free(q);
+		p = mm_malloc(size);
+		CHECK(p != NULL && guard != NULL);
+		if (p == NULL || guard == NULL)
+			break;
+		us = mm_usable_size(p);
+		fill(p, 0x5a);
+		fill(guard, 0x3c);
+
+		CHECK(mm_try_expand(p, us / 2, us / 2) == us); /* never shrinks */
+		CHECK(mm_try_expand(p, us, us) == us);
+
+		min = us + size / 2;
+		max = us + size;
+		got = mm_try_expand(p, min, max);
+		CHECK(got == mm_usable_size(p));
+		if (got >= min) {
+			grown++;
+			CHECK(got < 2 * max + 64); /* at most max plus rounding (buddy: next power of two) */
+			CHECK(intact(p, us, 0x5a));
+			memset(p, 0x5a, got);
+		} else
+			CHECK(got == us); /* failure leaves the block alone */
+
+		/* max below min counts as min */
+		us = mm_usable_size(p);
+		got = mm_try_expand(p, us + 8, 0);
+		CHECK(got == mm_usable_size(p));
+		CHECK(intact(p, us, 0x5a));
+		memset(p, 0x5a, got);
+		CHECK(intact(guard, mm_usable_size(guard), 0x3c)); /* growth stops short of the next live block */
+		mm_free(p);
+		mm_free(guard);
+	}
+	CHECK(grown > 0);
+
+	/* "As far as possible" asks the heap only for what it has left: no failed sbrk on the way */
+	p = mm_malloc(100000);
+	CHECK(p != NULL);
+	if (p != NULL) {
+		us = mm_usable_size(p);
+		errno = 0;
+		got = mm_try_expand(p, us + 1000, SIZE_MAX);
+		CHECK(errno == 0);
+		CHECK(got == mm_usable_size(p) && got >= us);
+		mm_free(p);
+	}
+}
+
+/*
+ * test_realloc_slab - a heap block realloc'd into a slab slot must not be
+ *     treated as a heap block afterwards. The slot has no header: the
+ *     word before it is the end of the previous slot's user data, here
+ *     made to look like a large block. Running out of heap makes mm.c
+ *     reclaim realloc growth reservations, which must leave A and C alone.
+ */
+static void test_realloc_slab(void)
+{
+	static void *hold[NHOLD];
+	unsigned char *p, *a, *b, *c, *r, *nb;
+	size_t i, n, nhold = 0, nfill;
+	int ok;
+
+	p = mm_malloc(300);
+	nb = mm_malloc(300); /* keeps p from growing in place */
+	CHECK(p != NULL && nb != NULL);
+	memset(p, 0x77, 10);
+	p = mm_realloc(p, 10); /* now a small heap block, followed by a free tail */
+	CHECK(p != NULL && intact(p, 10, 0x77));
+	for (nfill = 0; nfill < NHOLD / 2; nfill++) { /* allocate until the tail (between p and nb) is taken back */
+		hold[nfill] = mm_malloc(300 - 32);
+		if (hold[nfill] == NULL || ((unsigned char *)hold[nfill] > p && (unsigned char *)hold[nfill] < nb))
+			break;
+	}
+
+	a = mm_malloc(100);
+	b = mm_malloc(100);
+	c = mm_malloc(100);
+	CHECK(a != NULL && b != NULL && c != NULL);
+	n = mm_usable_size(a) / sizeof(uint32_t);
+	for (i = 0; i < n; i++)
+		((uint32_t *)a)[i] = 0x00010000; /* a big "block size" */
+	fill(c, 0xc3);
+	mm_free(b);
+
+	r = mm_realloc(p, 100); /* typically b's slot */
+	CHECK(r != NULL && intact(r, 10, 0x77));
+	memset(r, 0x77, 100);
+
+	nhold = nfill + 1;
+	while (nhold < NHOLD && (hold[nhold] = mm_malloc(HOLD_SIZE)) != NULL)
+		nhold++;
+	for (i = 0; i < nhold; i++)
+		mm_free(hold[i]);
+
+	for (ok = 1, i = 0; i < n; i++)
+		ok &= ((uint32_t *)a)[i] == 0x00010000;
+	CHECK(ok);
+	CHECK(intact(c, mm_usable_size(c), 0xc3));
+	CHECK(intact(r, 100, 0x77));
+	mm_free(a);
+	mm_free(c);
+	mm_free(r);
+	mm_free(nb);
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = argc > 1 ? argv[1] : "mm.c";
+
+	mem_init();
+	if (mm_init() < 0) {
+		fprintf(stderr, "mm_init failed\n");
+		exit(1);
+	}
+
+	test_memalign();
+	test_calloc();
+	test_batch();
+	test_usable_expand();
+	test_realloc_slab(); /* last: runs the heap out of memory */
+
+	if (nfailed) {
+		printf("%s: %d of %d checks FAILED\n", name, nfailed, nchecks);
+		exit(1);
+	}
+	printf("%s: %d checks passed\n", name, nchecks);
+	mem_deinit();
+	return 0;
+}
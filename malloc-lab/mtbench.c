@@ -0,0 +1,214 @@
+/*
+ * mtbench.c - Producer/consumer benchmark for the MM_THREADS build
+ *
+ * Each of NPAIRS producer threads allocates messages with mm_malloc,
+ * fills them, and hands them to its consumer thread through a bounded
+ * single-producer/single-consumer ring. The consumer checks the payload
+ * and frees it with mm_free. Every free therefore happens on a thread
+ * other than the one that allocated the block, which is the path served
+ * by the per-arena remote free stacks in mm.c.
+ *
+ * Build with "make mtbench" (mm.c is compiled with -DMM_THREADS). With
+ * CFLAGS+=' -DMM_DECAY=1' it also reports the pages purged by the decay
+ * worker and how many of them were faulted back in.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "mm.h"
+#include "memlib.h"
+
+/* Defaults (overridable from the command line) */
+#define DEFAULT_PAIRS 4		   /* producer/consumer pairs */
+#define DEFAULT_MSGS 1000000   /* messages per producer */
+#define DEFAULT_MAXSIZE 512	   /* largest message payload in bytes */
+#define RING_SIZE 1024		   /* slots per ring (power of two) */
+
+/* Bounded SPSC ring between one producer and one consumer */
+typedef struct
+{
+	void *slot[RING_SIZE];
+	size_t size[RING_SIZE];
+	unsigned long head __attribute__((aligned(64))); /* next slot to fill (producer) */
+	unsigned long tail __attribute__((aligned(64))); /* next slot to drain (consumer) */
+} ring_t;
+
+typedef struct
+{
+	ring_t ring;
+	unsigned seed;
+	int failed;
+} pair_t;
+
+static int nmsgs = DEFAULT_MSGS;
+static int idle_ms;	/* idle time after the run before reporting memory (-w) */
+static int maxsize = DEFAULT_MAXSIZE;
+
+static void usage(void);
+
+/*
+ * producer - allocate messages and push them onto the pair's ring
+ */
+static void *producer(void *arg)
+{
+	pair_t *pr = arg;
+	ring_t *r = &pr->ring;
+	unsigned seed = pr->seed;
+	int i;
+
+	for (i = 0; i < nmsgs; i++) {
+		size_t n = rand_r(&seed) % maxsize + 1;
+		unsigned long h = r->head;
+		char *p;
+
+		while (h - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == RING_SIZE)
+			sched_yield(); /* ring full */
+
+		if ((p = mm_malloc(n)) == NULL) {
+			pr->failed = 1;
+			n = 0; /* tell the consumer to skip this slot */
+		} else
+			memset(p, (int)(n & 0xff), n);
+		r->slot[h % RING_SIZE] = p;
+		r->size[h % RING_SIZE] = n;
+		__atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+/*
+ * consumer - pop messages from the pair's ring, check them and free them
+ */
+static void *consumer(void *arg)
+{
+	pair_t *pr = arg;
+	ring_t *r = &pr->ring;
+	int i;
+
+	for (i = 0; i < nmsgs; i++) {
+		unsigned long t = r->tail;
+		unsigned char *p;
+		size_t n, j;
+
+		while (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == t)
+			sched_yield(); /* ring empty */
+
+		p = r->slot[t % RING_SIZE];
+		n = r->size[t % RING_SIZE];
+		__atomic_store_n(&r->tail, t + 1, __ATOMIC_RELEASE);
+
+		if (p == NULL)
+			continue;
+		for (j = 0; j < n; j += 64) /* spot-check the payload */
+			if (p[j] != (unsigned char)(n & 0xff))
+				pr->failed = 1;
+		mm_free(p);
+	}
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	int npairs = DEFAULT_PAIRS;
+	pthread_t *tids;
+	pair_t *pairs;
+	struct timespec t0, t1;
+	double secs;
+	int c, i, failed = 0;
+
+	while ((c = getopt(argc, argv, "t:n:s:w:h")) != EOF) {
+		switch (c) {
+		case 't':
+			npairs = atoi(optarg);
+			break;
+		case 'n':
+			nmsgs = atoi(optarg);
+			break;
+		case 's':
+			maxsize = atoi(optarg);
+			break;
+		case 'w':
+			idle_ms = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			exit(0);
+		default:
+			usage();
+			exit(1);
+		}
+	}
+	if (npairs < 1 || nmsgs < 1 || maxsize < 1 || idle_ms < 0) {
+		usage();
+		exit(1);
+	}
+
+	mem_init();
+	if (mm_init() < 0) {
+		fprintf(stderr, "mm_init failed\n");
+		exit(1);
+	}
+
+	pairs = calloc(npairs, sizeof(pair_t));
+	tids = calloc(2 * npairs, sizeof(pthread_t));
+	if (pairs == NULL || tids == NULL) {
+		fprintf(stderr, "calloc failed\n");
+		exit(1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < npairs; i++) {
+		pairs[i].seed = i + 1;
+		pthread_create(&tids[2 * i], NULL, producer, &pairs[i]);
+		pthread_create(&tids[2 * i + 1], NULL, consumer, &pairs[i]);
+	}
+	for (i = 0; i < 2 * npairs; i++)
+		pthread_join(tids[i], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	for (i = 0; i < npairs; i++)
+		failed |= pairs[i].failed;
+	secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+	printf("pairs %d, msgs/producer %d, max size %d\n", npairs, nmsgs, maxsize);
+	printf("%.3f secs, %.0f Kops/sec (malloc+free pairs), heap %zu bytes\n",
+		   secs, (double)npairs * nmsgs / secs / 1e3, mem_heapsize());
+#if defined(MM_DECAY) && MM_DECAY
+	usleep(idle_ms * 1000); /* give the decay worker time to purge */
+	{
+		size_t purged, refaulted;
+		mm_decay_stats(&purged, &refaulted);
+		printf("decay: %zu pages purged, %zu refaulted, resident %zu bytes\n",
+			   purged, refaulted, mem_resident());
+		mm_decay_shutdown();
+	}
+#endif
+	if (failed) {
+		printf("ERROR: allocation failure or corrupted payload\n");
+		exit(1);
+	}
+
+	free(pairs);
+	free(tids);
+	mem_deinit();
+	return 0;
+}
+
+/*
+ * usage - Explain the command line arguments
+ */
+static void usage(void)
+{
+	fprintf(stderr, "Usage: mtbench [-h] [-t <pairs>] [-n <msgs>] [-s <maxsize>] [-w <ms>]\n");
+	fprintf(stderr, "Options\n");
+	fprintf(stderr, "\t-h         Print this message.\n");
+	fprintf(stderr, "\t-t <pairs> Producer/consumer thread pairs (default %d).\n", DEFAULT_PAIRS);
+	fprintf(stderr, "\t-n <msgs>  Messages per producer (default %d).\n", DEFAULT_MSGS);
+	fprintf(stderr, "\t-s <size>  Largest message in bytes (default %d).\n", DEFAULT_MAXSIZE);
+	fprintf(stderr, "\t-w <ms>    Idle time before reporting decay counters (MM_DECAY builds).\n");
+}